@@ -0,0 +1,113 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "LoadProgress.hpp"
+
+#include <filesystem>
+
+LoadProgress::Stage LoadProgress::stage() const {
+    return stage_.load();
+}
+
+void LoadProgress::setStage(LoadProgress::Stage stage) {
+    stage_.store(stage);
+}
+
+void LoadProgress::cancel() {
+    cancelled_.store(true);
+}
+
+bool LoadProgress::cancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+}
+
+void LoadProgress::setLocations(const DefinitionRegistry &registry, const std::string &tracePath) {
+    // Events of each location are stored in <archive>/<location ref>.evt next to the anchor file
+    auto anchor = std::filesystem::path(tracePath);
+    auto archive = anchor.parent_path() / anchor.stem();
+
+    std::lock_guard lock(countersMutex_);
+    counters_.clear();
+    for (const auto &location: registry.locations()) {
+        auto ref = location->ref().get();
+        if (ref >= counters_.size()) {
+            counters_.resize(ref + 1);
+        }
+
+        std::error_code error;
+        auto bytes = std::filesystem::file_size(archive / (std::to_string(ref) + ".evt"), error);
+
+        counters_[ref] = std::make_unique<Counter>();
+        counters_[ref]->location = location;
+        counters_[ref]->totalEvents = location->num_events();
+        counters_[ref]->totalBytes = error ? 0 : bytes;
+    }
+}
+
+std::vector<LoadProgress::Location> LoadProgress::locations() const {
+    std::lock_guard lock(countersMutex_);
+    std::vector<Location> locations;
+    for (const auto &counter: counters_) {
+        if (!counter) {
+            continue;
+        }
+
+        auto events = std::min(counter->events.load(std::memory_order_relaxed), counter->totalEvents);
+        // Events are not of equal size, assuming so is good enough for displaying progress
+        auto bytes = counter->totalEvents ? counter->totalBytes * events / counter->totalEvents : 0;
+        locations.push_back({counter->location, events, counter->totalEvents, bytes, counter->totalBytes});
+    }
+    return locations;
+}
+
+std::pair<std::uint64_t, std::uint64_t> LoadProgress::events() const {
+    std::uint64_t events = 0;
+    std::uint64_t totalEvents = 0;
+    for (const auto &location: locations()) {
+        events += location.events;
+        totalEvents += location.totalEvents;
+    }
+    return {events, totalEvents};
+}
+
+void LoadProgress::publish(std::size_t shard,
+                           std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots,
+                           std::optional<otf2::chrono::time_point> programStart) {
+    std::lock_guard lock(publishedMutex_);
+    published_[shard] = {std::move(slots), programStart};
+    generation_.fetch_add(1);
+}
+
+std::uint64_t LoadProgress::generation() const {
+    return generation_.load();
+}
+
+LoadProgress::PartialSlots LoadProgress::partialSlots() const {
+    std::lock_guard lock(publishedMutex_);
+    PartialSlots partial;
+    partial.generation = generation_.load();
+    for (const auto &[shard, published]: published_) {
+        // Shards contain disjoint location groups
+        for (const auto &[locationGroup, slots]: published.slots) {
+            partial.slots.insert({locationGroup, slots});
+        }
+        if (published.programStart && (!partial.programStart || *published.programStart < *partial.programStart)) {
+            partial.programStart = published.programStart;
+        }
+    }
+    return partial;
+}
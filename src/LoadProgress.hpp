@@ -0,0 +1,187 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_LOADPROGRESS_HPP
+#define MOTIV_LOADPROGRESS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "src/models/DefinitionRegistry.hpp"
+#include "src/models/SlotStore.hpp"
+#include "src/models/Trace.hpp"
+
+/**
+ * @brief Progress of loading a trace, shared between the loading threads and the UI
+ *
+ * The readers count every event they process per location and periodically publish the slots they have completed so
+ * far. The UI polls the progress, can display the partial slots and may cancel the loading at any time. All methods
+ * are thread safe.
+ */
+class LoadProgress {
+public:
+    /**
+     * @brief Stages of loading a trace
+     */
+    enum Stage {
+        ReadingDefinitions,
+        ReadingEvents,
+        Linking,
+        Done
+    };
+
+    /**
+     * @brief Progress of a single location
+     */
+    struct Location {
+        otf2::definition::location *location; /**< The location */
+        std::uint64_t events; /**< Number of events processed */
+        std::uint64_t totalEvents; /**< Number of events of the location as defined in the trace */
+        std::uint64_t bytes; /**< Estimated number of bytes of the event file processed */
+        std::uint64_t totalBytes; /**< Size of the event file of the location */
+    };
+
+    /**
+     * @brief Slots completed so far by all readers
+     */
+    struct PartialSlots {
+        std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots; /**< Unsorted slots with absolute times */
+        std::optional<otf2::chrono::time_point> programStart; /**< Earliest program begin read so far */
+        std::uint64_t generation = 0; /**< Incremented on every publication */
+    };
+
+public:
+    /**
+     * @brief Returns the current stage
+     * @return The current stage
+     */
+    [[nodiscard]] Stage stage() const;
+
+    /**
+     * @brief Sets the current stage
+     * @param stage The new stage
+     */
+    void setStage(Stage stage);
+
+    /**
+     * @brief Requests the loading to be cancelled
+     *
+     * The readers stop processing events as soon as they notice the request.
+     */
+    void cancel();
+
+    /**
+     * @brief Returns whether cancelling was requested
+     * @return Whether cancelling was requested
+     */
+    [[nodiscard]] bool cancelled() const;
+
+    /**
+     * @brief Sets up the counters of all locations
+     *
+     * Has to be called after the definitions have been read and before any event is counted.
+     *
+     * @param registry Registry containing all locations of the trace
+     * @param tracePath Path to the anchor file of the trace, used to determine the sizes of the event files
+     */
+    void setLocations(const DefinitionRegistry &registry, const std::string &tracePath);
+
+    /**
+     * @brief Counts a processed event
+     *
+     * @param location Reference of the location of the event
+     */
+    void countEvent(otf2::reference<otf2::definition::location> location) {
+        auto ref = location.get();
+        if (ref < counters_.size() && counters_[ref]) {
+            counters_[ref]->events.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Returns the progress of all locations
+     * @return The progress per location
+     */
+    [[nodiscard]] std::vector<Location> locations() const;
+
+    /**
+     * @brief Returns the number of processed and the total number of events of all locations
+     * @return Pair of processed and total events
+     */
+    [[nodiscard]] std::pair<std::uint64_t, std::uint64_t> events() const;
+
+    /**
+     * @brief Publishes the slots completed by a reader
+     *
+     * Replaces the slots previously published by the same reader.
+     *
+     * @param shard Index of the shard read by the reader
+     * @param slots Slots completed by the reader
+     * @param programStart Program begin read by the reader, if any
+     */
+    void publish(std::size_t shard, std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots,
+                 std::optional<otf2::chrono::time_point> programStart);
+
+    /**
+     * @brief Returns the generation of the published slots
+     *
+     * The generation changes whenever a reader publishes new slots.
+     *
+     * @return The generation of the published slots
+     */
+    [[nodiscard]] std::uint64_t generation() const;
+
+    /**
+     * @brief Returns a copy of the slots published by all readers
+     * @return The published slots
+     */
+    [[nodiscard]] PartialSlots partialSlots() const;
+
+private:
+    struct Counter {
+        otf2::definition::location *location;
+        std::uint64_t totalEvents;
+        std::uint64_t totalBytes;
+        std::atomic<std::uint64_t> events{0};
+    };
+
+    std::atomic<Stage> stage_{ReadingDefinitions};
+    std::atomic<bool> cancelled_{false};
+
+    /**
+     * Counters indexed by the reference of their location. Only set up before any event is counted, so counting does
+     * not need to lock.
+     */
+    std::vector<std::unique_ptr<Counter>> counters_;
+    mutable std::mutex countersMutex_;
+
+    struct Published {
+        std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots;
+        std::optional<otf2::chrono::time_point> programStart;
+    };
+
+    std::map<std::size_t, Published> published_;
+    std::atomic<std::uint64_t> generation_{0};
+    mutable std::mutex publishedMutex_;
+};
+
+#endif //MOTIV_LOADPROGRESS_HPP
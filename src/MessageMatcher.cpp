@@ -0,0 +1,119 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MessageMatcher.hpp"
+
+namespace {
+    /**
+     * Initial number of entries of the table, a power of two
+     */
+    const std::size_t INITIAL_CAPACITY = 1024;
+
+    std::uint64_t mix(std::uint64_t x) {
+        // Finalizer of splitmix64
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+}
+
+MessageMatcher::MessageMatcher() : table_(INITIAL_CAPACITY) {}
+
+CommunicationEvent *MessageMatcher::match(Side side, const Key &key, CommunicationEvent *event) {
+    auto *entry = &find(key);
+    if (!entry->used) {
+        // Keep the load factor below 1/2, so probe sequences stay short
+        if ((used_ + 1) * 2 > table_.size()) {
+            grow();
+            entry = &find(key);
+        }
+        entry->key = key;
+        entry->used = true;
+        ++used_;
+    }
+
+    // Match the oldest pending event of the other side
+    if (entry->head != NONE && entry->side != side) {
+        auto node = entry->head;
+        entry->head = nodes_[node].next;
+        if (entry->head == NONE) {
+            entry->tail = NONE;
+        }
+        nodes_[node].next = freeNodes_;
+        freeNodes_ = node;
+        --pending_[entry->side];
+        return nodes_[node].event;
+    }
+
+    std::uint32_t node;
+    if (freeNodes_ != NONE) {
+        node = freeNodes_;
+        freeNodes_ = nodes_[node].next;
+        nodes_[node] = {event, NONE};
+    } else {
+        node = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.push_back({event, NONE});
+    }
+
+    if (entry->tail != NONE) {
+        nodes_[entry->tail].next = node;
+    } else {
+        entry->head = node;
+        entry->side = side;
+    }
+    entry->tail = node;
+    ++pending_[side];
+    return nullptr;
+}
+
+void MessageMatcher::clear() {
+    table_.assign(INITIAL_CAPACITY, Entry());
+    used_ = 0;
+    nodes_.clear();
+    freeNodes_ = NONE;
+    pending_[Send] = 0;
+    pending_[Receive] = 0;
+}
+
+std::size_t MessageMatcher::hash(const Key &key) {
+    auto h = mix(reinterpret_cast<std::uintptr_t>(key.communicator));
+    h = mix(h ^ key.sender);
+    h = mix(h ^ key.receiver);
+    return static_cast<std::size_t>(mix(h ^ key.tag));
+}
+
+MessageMatcher::Entry &MessageMatcher::find(const Key &key) {
+    auto mask = table_.size() - 1;
+    for (auto i = hash(key) & mask;; i = (i + 1) & mask) {
+        if (!table_[i].used || table_[i].key == key) {
+            return table_[i];
+        }
+    }
+}
+
+void MessageMatcher::grow() {
+    std::vector<Entry> old(table_.size() * 2);
+    old.swap(table_);
+    for (const auto &entry: old) {
+        if (entry.used) {
+            find(entry.key) = entry;
+        }
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_MESSAGEMATCHER_HPP
+#define MOTIV_MESSAGEMATCHER_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "src/types.hpp"
+#include "src/models/communication/CommunicationEvent.hpp"
+
+/**
+ * @brief Matches the sends and receives of point to point messages
+ *
+ * MPI messages between two ranks on the same communicator with the same tag do not overtake each other. Events are
+ * therefore queued per (communicator, sender, receiver, tag) and a send is matched with the oldest pending receive of
+ * its key and vice versa. A queue only ever holds events of one side, as an event of the other side is matched
+ * immediately.
+ *
+ * Keys are stored in an open addressing hash table, the queues are linked lists of nodes in a single pool that reuses
+ * the nodes of matched events. Matching an event neither allocates nor follows pointers beyond the table and the pool.
+ */
+class MessageMatcher {
+public:
+    /**
+     * @brief Side of a message an event belongs to
+     */
+    enum Side : std::uint8_t {
+        Send,
+        Receive
+    };
+
+    /**
+     * @brief Identifies the messages that are matched in order
+     */
+    struct Key {
+        const types::communicator *communicator; /**< Communicator of the message */
+        std::uint64_t sender; /**< Rank of the sender */
+        std::uint64_t receiver; /**< Rank of the receiver */
+        std::uint32_t tag; /**< Tag of the message */
+
+        bool operator==(const Key &rhs) const = default;
+    };
+
+    /**
+     * @brief Creates an empty matcher
+     */
+    MessageMatcher();
+
+    /**
+     * @brief Matches an event with the oldest pending event of the other side, or queues it if there is none
+     *
+     * @param side Side of the event
+     * @param key Key of the message
+     * @param event The event
+     * @return The matched event of the other side, nullptr if the event was queued
+     */
+    CommunicationEvent *match(Side side, const Key &key, CommunicationEvent *event);
+
+    /**
+     * @brief Returns the number of events not matched so far
+     */
+    [[nodiscard]] std::size_t pending(Side side) const { return pending_[side]; }
+
+    /**
+     * @brief Calls a function for every event not matched so far
+     *
+     * @param fn Function called with the side, the key and the event
+     */
+    template<typename F>
+    void forEachPending(F fn) const {
+        for (const auto &entry: table_) {
+            for (auto node = entry.head; entry.used && node != NONE; node = nodes_[node].next) {
+                fn(entry.side, entry.key, nodes_[node].event);
+            }
+        }
+    }
+
+    /**
+     * @brief Drops all keys and pending events
+     */
+    void clear();
+
+private:
+    static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    struct Entry {
+        Key key{};
+        std::uint32_t head = NONE;
+        std::uint32_t tail = NONE;
+        Side side = Send;
+        bool used = false;
+    };
+
+    struct Node {
+        CommunicationEvent *event;
+        std::uint32_t next;
+    };
+
+    [[nodiscard]] static std::size_t hash(const Key &key);
+
+    Entry &find(const Key &key);
+
+    void grow();
+
+    std::vector<Entry> table_;
+    std::size_t used_ = 0;
+    std::vector<Node> nodes_;
+    std::uint32_t freeNodes_ = NONE;
+    std::size_t pending_[2] = {0, 0};
+};
+
+#endif //MOTIV_MESSAGEMATCHER_HPP
@@ -22,289 +22,324 @@
 #include "src/models/communication/BlockingSendEvent.hpp"
 #include "src/models/communication/BlockingReceivEevent.hpp"
 #include "src/models/communication/NonBlockingSendEvent.hpp"
+#include <QDebug>
 #include <QStringListModel>
 #include <memory>
 #include <utility>
 #include <type_traits>
 
-ReaderCallbacks::ReaderCallbacks(otf2::reader::reader &rdr) :
-    slots_(std::vector<Slot*>()),
-    communications_(std::vector<Communication*>()),
-    collectiveCommunications_(std::vector<CollectiveCommunicationEvent*>()),
+ReaderCallbacks::ReaderCallbacks(otf2::reader::reader &rdr, DefinitionRegistry &registry, std::size_t shard,
+                                 std::size_t shardCount, LoadProgress *progress) :
+    slots_(),
+    communicationRecords_(std::vector<CommunicationRecord>()),
     slotsBuilding(),
-    program_start_(),
-    rdr_(rdr) {
+    rdr_(rdr),
+    registry_(registry),
+    shard_(shard),
+    shardCount_(shardCount),
+    progress_(progress) {
         
 }
 
 
-std::vector<Slot*> ReaderCallbacks::getSlots() {
+std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &ReaderCallbacks::getSlots() {
     return this->slots_;
 }
 
-otf2::chrono::duration ReaderCallbacks::duration() const {
-    return this->program_end_ - this->program_start_;
+std::optional<otf2::chrono::time_point> ReaderCallbacks::programStart() const {
+    return this->program_start_;
+}
+
+std::optional<otf2::chrono::time_point> ReaderCallbacks::programEnd() const {
+    return this->program_end_;
+}
+
+void ReaderCallbacks::definition(const otf2::definition::location_group &group) {
+    if (shard_ == 0) {
+        registry_.add(group);
+    }
 }
 
 void ReaderCallbacks::definition(const otf2::definition::location &loc) {
-    rdr_.register_location(loc);
+    if (shard_ == 0) {
+        registry_.add(loc);
+    }
+
+    // All locations of a location group are read by the same shard, this way slots can be grouped per shard.
+    if (loc.location_group().ref().get() % shardCount_ == shard_) {
+        rdr_.register_location(loc);
+    }
 }
 
-void ReaderCallbacks::event(const otf2::definition::location &, const otf2::event::program_begin &event) {
-    this->program_start_ = event.timestamp();
+void ReaderCallbacks::definition(const otf2::definition::region &region) {
+    if (shard_ == 0) {
+        registry_.add(region);
+    }
 }
 
-void ReaderCallbacks::event(const otf2::definition::location &, const otf2::event::program_end &event) {
-    this->program_end_ = event.timestamp();
+void ReaderCallbacks::definition(const otf2::definition::comm &comm) {
+    if (shard_ == 0) {
+        registry_.add(comm);
+    }
 }
 
+void ReaderCallbacks::definition(const otf2::definition::inter_comm &comm) {
+    if (shard_ == 0) {
+        registry_.add(comm);
+    }
+}
 
-void ReaderCallbacks::event(const otf2::definition::location &loc, const otf2::event::enter &event) {
-    auto start = event.timestamp() - this->program_start_;
+void ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::program_begin &event) {
+    if (!this->process(location)) {
+        return;
+    }
 
-    Slot::Builder builder{};
-    auto region = new otf2::definition::region(event.region());
-    auto location = new otf2::definition::location(loc);
-    builder.start(start)->location(location)->region(region);
+    if (!this->program_start_ || event.timestamp() < *this->program_start_) {
+        this->program_start_ = event.timestamp();
+    }
+}
 
-    std::vector<Slot::Builder> *builders;
-    auto buildersIt = this->slotsBuilding.find(location->ref().get());
-    if (buildersIt == this->slotsBuilding.end()) {
-        builders = new std::vector<Slot::Builder>();
-        this->slotsBuilding.insert({location->ref().get(), builders});
-    } else {
-        builders = buildersIt->second;
+void ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::program_end &event) {
+    if (!this->process(location)) {
+        return;
     }
 
-    builders->push_back(builder);
+    if (!this->program_end_ || event.timestamp() > *this->program_end_) {
+        this->program_end_ = event.timestamp();
+    }
 }
 
-void ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::leave &event) {
-    auto builders = this->slotsBuilding.at(location.ref().get());
 
-    Slot::Builder &builder = builders->back();
+void ReaderCallbacks::event(const otf2::definition::location &loc, const otf2::event::enter &event) {
+    if (!this->process(loc)) {
+        return;
+    }
 
-    auto end = event.timestamp() - this->program_start_;
-    builder.end(end);
+    auto start = absolute(event.timestamp());
 
-    this->slots_.push_back(new Slot(builder.build()));
+    auto callStackIt = this->slotsBuilding.find(loc.ref());
+    if (callStackIt == this->slotsBuilding.end()) {
+        auto locationGroup = registry_.locationGroup(loc.location_group().ref());
+        auto slotsIt = this->slots_.try_emplace(locationGroup, &registry_).first;
+        callStackIt = this->slotsBuilding.insert({loc.ref(), {&slotsIt->second, {}}}).first;
+    }
 
-    builders->pop_back();
+    callStackIt->second.pending.push_back({start, static_cast<std::uint32_t>(event.region().ref().get())});
 }
 
-
-template<typename T>
-void ReaderCallbacks::communicationEvent(T* self, uint32_t matching,
-                                         std::map<uint32_t, std::vector<CommunicationEvent*> *> &selfPending,
-                                         std::map<uint32_t, std::vector<CommunicationEvent*> *> &matchingPending
-) {
-    // Check for a pending matching call
-    if (matchingPending.contains(matching)) {
-        auto& matchingEvents = matchingPending[matching];
-        auto matchingEvent = matchingEvents->back();
-
-        auto communication = new Communication(matchingEvent, self);
-        communications_.push_back(communication);
-
-        matchingEvents->pop_back();
-        if (matchingEvents->empty()) {
-            delete matchingEvents;
-            matchingPending.erase(matching);
-        }
-    } else {
-        std::vector<CommunicationEvent*> *matchingEvents;
-        auto id = self->getLocation()->ref().get();
-        if (selfPending.contains(id)) {
-            matchingEvents = selfPending[id];
-        } else {
-            matchingEvents = new std::vector<CommunicationEvent*>();
-            selfPending[id] = matchingEvents;
-        }
-
-        matchingEvents->push_back(self);
+void ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::leave &event) {
+    if (!this->process(location)) {
+        return;
     }
+
+    auto &callStack = this->slotsBuilding.at(location.ref());
+
+    const PendingSlot &pending = callStack.pending.back();
+
+    auto end = absolute(event.timestamp());
+    auto depth = static_cast<std::uint32_t>(callStack.pending.size() - 1);
+    callStack.slots->push_back(pending.start, end, pending.region, depth);
+
+    callStack.pending.pop_back();
 }
 
 void ReaderCallbacks::event(const otf2::definition::location &loc, const otf2::event::mpi_send &send) {
-    auto location = new otf2::definition::location(loc);
-    auto comm = new types::communicator(send.comm());
-    auto ev = new BlockingSendEvent(relative(send.timestamp()), location, comm);
+    if (!this->process(loc)) {
+        return;
+    }
 
-    this->communicationEvent<BlockingSendEvent>(ev, send.receiver(), pendingSends, pendingReceives);
+    auto location = registry_.location(loc.ref());
+    auto comm = registry_.communicator(send.comm());
+    auto time = absolute(send.timestamp());
+
+    this->communicationRecords_.push_back(
+        {CommunicationRecord::BlockingSend, time, time, location, comm, send.receiver(), {}, send.msg_tag()});
 }
 
 void ReaderCallbacks::event(const otf2::definition::location &loc, const otf2::event::mpi_receive &receive) {
-    auto location = new otf2::definition::location(loc);
-    auto comm = new types::communicator(receive.comm());
-    auto ev = new BlockingReceiveEvent(relative(receive.timestamp()), location, comm);
+    if (!this->process(loc)) {
+        return;
+    }
+
+    auto location = registry_.location(loc.ref());
+    auto comm = registry_.communicator(receive.comm());
+    auto time = absolute(receive.timestamp());
 
-    this->communicationEvent(ev, receive.sender(), pendingReceives, pendingSends);
+    this->communicationRecords_.push_back(
+        {CommunicationRecord::BlockingReceive, time, time, location, comm, receive.sender(), {}, receive.msg_tag()});
 }
 
 void ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::mpi_isend_request &request) {
+    if (!this->process(location)) {
+        return;
+    }
+
     NonBlockingSendEvent::Builder builder;
-    auto comm = new types::communicator (request.comm());
-    auto loc = new otf2::definition::location(location);
-    auto start = relative(request.timestamp());
+    auto comm = registry_.communicator(request.comm());
+    auto loc = registry_.location(location.ref());
+    auto start = absolute(request.timestamp());
     auto receiver = request.receiver();
+    auto tag = request.msg_tag();
     builder.communicator(comm);
     builder.location(loc);
     builder.start(start);
     builder.receiver(receiver);
+    builder.tag(tag);
 
     this->uncompletedRequests.insert({request.request_id(), builder});
 }
 
 void
-ReaderCallbacks::event(const otf2::definition::location &, const otf2::event::mpi_isend_complete &complete) {
-    if (!uncompletedRequests.contains(complete.request_id())) {
+ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::mpi_isend_complete &complete) {
+    if (!this->process(location)) {
+        return;
+    }
+
+    auto request = uncompletedRequests.find(complete.request_id());
+    if (request == uncompletedRequests.end()) {
         throw std::logic_error("Found a mpi_isend_complete event with no matching mpi_isend_request event!");
     }
 
-    auto builderVariant = uncompletedRequests[complete.request_id()];
-    if(!holds_alternative<NonBlockingSendEvent::Builder>(builderVariant)) {
+    if(!holds_alternative<NonBlockingSendEvent::Builder>(request->second)) {
         throw std::logic_error("mpi_isend_complete event completes an mpi_ireceive event!");
     }
-    
-    auto builder = get<NonBlockingSendEvent::Builder>(builderVariant);
 
-    auto end = relative(complete.timestamp());
-    builder.end(end);
+    auto builder = get<NonBlockingSendEvent::Builder>(request->second);
+    uncompletedRequests.erase(request);
 
-    auto ev = new NonBlockingSendEvent(builder.build());
-
-    communicationEvent(ev, builder.receiver(), pendingSends, pendingReceives);
+    this->communicationRecords_.push_back(
+        {CommunicationRecord::NonBlockingSend, absolute(complete.timestamp()), *builder.start(),
+         *builder.location(), *builder.communicator(), builder.receiver(), {}, builder.tag()});
 }
 
 void
-ReaderCallbacks::event(const otf2::definition::location &, const otf2::event::mpi_ireceive_complete &complete) {
-    if (!uncompletedRequests.contains(complete.request_id())) {
+ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::mpi_ireceive_complete &complete) {
+    if (!this->process(location)) {
+        return;
+    }
+
+    auto request = uncompletedRequests.find(complete.request_id());
+    if (request == uncompletedRequests.end()) {
         throw std::logic_error("Found a mpi_ireceive_complete event with no matching mpi_ireceive_request event!");
     }
 
-    auto builderVariant = uncompletedRequests[complete.request_id()];
-    if(!holds_alternative<NonBlockingReceiveEvent::Builder>(builderVariant)) {
+    if(!holds_alternative<NonBlockingReceiveEvent::Builder>(request->second)) {
         throw std::logic_error("mpi_ireceive_complete event completes an mpi_isend event!");
     }
 
-    auto builder = get<NonBlockingReceiveEvent::Builder>(builderVariant);
-
-    auto end = relative(complete.timestamp());
-    builder.end(end);
+    auto builder = get<NonBlockingReceiveEvent::Builder>(request->second);
+    uncompletedRequests.erase(request);
 
-    auto ev = new NonBlockingReceiveEvent(builder.build());
-
-    communicationEvent(ev, builder.sender(), pendingReceives, pendingSends);
+    this->communicationRecords_.push_back(
+        {CommunicationRecord::NonBlockingReceive, absolute(complete.timestamp()), *builder.start(),
+         *builder.location(), *builder.communicator(), builder.sender(), {}, builder.tag()});
 }
 
 void
 ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::mpi_ireceive_request &request) {
+    if (!this->process(location)) {
+        return;
+    }
 
     NonBlockingReceiveEvent::Builder builder;
-    auto comm = new types::communicator (request.comm());
-    auto loc = new otf2::definition::location(location);
-    auto start = relative(request.timestamp());
+    auto comm = registry_.communicator(request.comm());
+    auto loc = registry_.location(location.ref());
+    auto start = absolute(request.timestamp());
     auto sender = request.sender();
+    auto tag = request.msg_tag();
     builder.communicator(comm);
     builder.location(loc);
     builder.start(start);
     builder.sender(sender);
+    builder.tag(tag);
 
     this->uncompletedRequests.insert({request.request_id(), builder});
 }
 
 void ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::mpi_request_test &test) {
+    if (!this->process(location)) {
+        return;
+    }
+
     callback::event(location, test);
 }
 
 void ReaderCallbacks::event(const otf2::definition::location &location,
                             const otf2::event::mpi_request_cancelled &cancelled) {
-    callback::event(location, cancelled);
+    if (!this->process(location)) {
+        return;
+    }
+
+    // Cancelled requests are never completed
+    uncompletedRequests.erase(cancelled.request_id());
 }
 
 void
 ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::mpi_collective_begin &begin) {
-    CollectiveCommunicationEvent::Member::Builder builder;
-    auto loc = new otf2::definition::location(location);
-    auto start = relative(begin.timestamp());
-    
-    builder.location(loc);
-    builder.start(start);
-    
-    this->ongoingCollectiveCommunicationMembers.insert({loc->ref().get(), builder});
+    if (!this->process(location)) {
+        return;
+    }
+
+    auto loc = registry_.location(location.ref());
+    auto time = absolute(begin.timestamp());
+
+    this->communicationRecords_.push_back(
+        {CommunicationRecord::CollectiveBegin, time, time, loc, nullptr, 0, {}});
 }
 
 void ReaderCallbacks::event(const otf2::definition::location &location, const otf2::event::mpi_collective_end &anEnd) {
-    if(ongoingCollectiveCommunication == nullptr) {
-        ongoingCollectiveCommunication = new CollectiveCommunicationEvent::Builder();
-        std::vector<CollectiveCommunicationEvent::Member*> members;
-        auto loc = new otf2::definition::location( location);
-        auto comm = new types::communicator (anEnd.comm());
-        auto operation = anEnd.type();
-        auto root = anEnd.root();
-        ongoingCollectiveCommunication->members(members);
-        ongoingCollectiveCommunication->location(loc);
-        ongoingCollectiveCommunication->communicator(comm);
-        ongoingCollectiveCommunication->operation(operation);
-        ongoingCollectiveCommunication->root(root);
-    }
-
-    auto member = ongoingCollectiveCommunicationMembers[location.ref().get()];
-    auto end = relative(anEnd.timestamp());
-    member.end(end);
-
-    ongoingCollectiveCommunication->members()->push_back(new CollectiveCommunicationEvent::Member(member.build()));
-    ongoingCollectiveCommunicationMembers.erase(location.ref().get());
-
-    // If the map is now empty, all ranks have completed the collective operation and the communication event can be build
-    if(ongoingCollectiveCommunicationMembers.empty()){
-        auto event = new CollectiveCommunicationEvent(ongoingCollectiveCommunication->build());
-        collectiveCommunications_.push_back(event);
-        delete ongoingCollectiveCommunication;
-        ongoingCollectiveCommunication = nullptr;
+    if (!this->process(location)) {
+        return;
     }
+
+    auto loc = registry_.location(location.ref());
+    auto comm = registry_.communicator(anEnd.comm());
+    auto time = absolute(anEnd.timestamp());
+
+    this->communicationRecords_.push_back(
+        {CommunicationRecord::CollectiveEnd, time, time, loc, comm, anEnd.root(), anEnd.type()});
 }
 
 
 void ReaderCallbacks::events_done(const otf2::reader::reader &) {
-    std::sort(this->slots_.begin(), this->slots_.end(), [](Slot *rhs, Slot *lhs) {
-        return rhs->startTime < lhs->startTime;
-    });
-    std::sort(this->communications_.begin(), this->communications_.end(),
-              [](Communication *rhs, Communication *lhs) {
-                  return rhs->getStartEvent()->getStartTime() < lhs->getStartEvent()->getStartTime();
-              });
-
-    for (const auto &item: this->slotsBuilding) {
-        // TODO: Warn about uncomplete slots
-        delete item.second;
-    }
-    for (const auto &item: this->pendingSends) {
-        // TODO: Warn about unmatched sends
-        delete item.second;
-    }
-    for (const auto &item: this->pendingReceives) {
-        // TODO: Warn about unmatched receives
-        delete item.second;
-    }
-//    for(const auto &item: this->uncompletedRequests) {
-//        // TODO: Warn about uncompleted (and not cancelled) requests
-//    }
-
-    std::destroy(this->slotsBuilding.begin(), this->slotsBuilding.end());
-    std::destroy(this->pendingSends.begin(), this->pendingSends.end());
-    std::destroy(this->pendingReceives.begin(), this->pendingReceives.end());
-    std::destroy(this->uncompletedRequests.begin(), this->uncompletedRequests.end());
+    std::size_t uncompletedSlots = 0;
+    for (const auto &[location, callStack]: this->slotsBuilding) {
+        uncompletedSlots += callStack.pending.size();
+    }
+    if (uncompletedSlots > 0) {
+        qWarning() << "ignoring" << uncompletedSlots << "regions entered but never left";
+    }
+
+    if (!this->uncompletedRequests.empty()) {
+        qWarning() << "ignoring" << this->uncompletedRequests.size() << "non blocking requests never completed";
+    }
+
+    this->slotsBuilding.clear();
+    this->uncompletedRequests.clear();
 }
 
-otf2::chrono::duration ReaderCallbacks::relative(otf2::chrono::time_point timepoint) const {
-    return timepoint - program_start_;
+bool ReaderCallbacks::process(const otf2::definition::location &location) {
+    if (!progress_) {
+        return true;
+    }
+
+    // otf2xx offers no way to interrupt reading, after cancelling the remaining events are skipped
+    if (progress_->cancelled()) {
+        return false;
+    }
+
+    progress_->countEvent(location.ref());
+    if (++eventsProcessed_ >= nextPublication_) {
+        nextPublication_ *= 2;
+        progress_->publish(shard_, slots_, program_start_);
+    }
+    return true;
 }
 
-std::vector<Communication*> ReaderCallbacks::getCommunications() {
-    return communications_;
+otf2::chrono::duration ReaderCallbacks::absolute(otf2::chrono::time_point timepoint) {
+    return timepoint.time_since_epoch();
 }
 
-std::vector<CollectiveCommunicationEvent*> ReaderCallbacks::getCollectiveCommunications() {
-    return collectiveCommunications_;
+const std::vector<CommunicationRecord> &ReaderCallbacks::getCommunicationRecords() const {
+    return communicationRecords_;
 }
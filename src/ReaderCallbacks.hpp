@@ -20,76 +20,136 @@
 
 #include <otf2xx/otf2.hpp>
 #include <cstdint>
+#include <optional>
 
+#include "src/LoadProgress.hpp"
+#include "src/models/DefinitionRegistry.hpp"
 #include "src/models/Slot.hpp"
+#include "src/models/SlotStore.hpp"
+#include "src/models/Trace.hpp"
 #include "src/models/communication/Communication.hpp"
 #include "src/models/communication/NonBlockingSendEvent.hpp"
 #include "src/models/communication/NonBlockingReceiveEvent.hpp"
 #include "src/models/communication/CollectiveCommunicationEvent.hpp"
 
-template<typename T>
-using BuilderSetLocation = std::function<typename T::Builder *(typename T::Builder &,
-                                                               otf2::definition::location &)>;
-
-template<typename T>
-using BuilderSetTime = std::function<typename T::Builder *(typename T::Builder &,
-                                                           otf2::chrono::duration &)>;
-
-template<typename T>
-using BuilderSetter = std::function<void(typename T::Builder &)>;
-
 typedef std::variant<NonBlockingSendEvent::Builder, NonBlockingReceiveEvent::Builder> NonBlockingCommunicationEventBuilder;
 
+/**
+ * @brief Communication related event recorded while reading a shard of the trace
+ *
+ * The partner of a point to point communication or the other members of a collective operation might be read by a
+ * different shard. Therefore, these events are only recorded while reading and linked after all shards have been read.
+ * All times are absolute and become relative to the program start when the records are linked.
+ */
+struct CommunicationRecord {
+    /**
+     * @brief Kinds of recorded events
+     */
+    enum Kind {
+        BlockingSend,
+        BlockingReceive,
+        NonBlockingSend,
+        NonBlockingReceive,
+        CollectiveBegin,
+        CollectiveEnd
+    };
+
+    Kind kind; /**< Kind of the recorded event */
+    otf2::chrono::duration time; /**< Time the event was completed, defines the order in which records are linked */
+    otf2::chrono::duration start; /**< Time the event was started, equals @c time for single time point events */
+    otf2::definition::location *location; /**< Location the event occurred on */
+    types::communicator *communicator; /**< Communicator of the event, nullptr for CollectiveBegin */
+    uint32_t peer; /**< Receiver of sends, sender of receives and root of collective operations */
+    otf2::collective_type operation; /**< Operation of CollectiveEnd records */
+    uint32_t tag = 0; /**< Message tag of point to point records */
+};
+
 /**
  * @brief Class implementing handlers for the otf readers events
  *
- * This class contains all the logic for parsing OTF2 traces into our custom data structures; including linking start
- * and end events of single operations to form a communication
+ * This class contains all the logic for parsing OTF2 traces into our custom data structures. One instance reads a
+ * single shard of the trace: only locations of the location groups (MPI ranks) assigned to the shard are registered
+ * with the reader. Slots are built completely by the shard, communication events are recorded as
+ * @ref CommunicationRecord and linked by the @ref TraceLoader once all shards have been read.
+ *
+ * Definitions are interned in a @ref DefinitionRegistry shared by all shards. Only the first shard fills the
+ * registry, all events refer to the interned definitions.
  */
 class ReaderCallbacks : public otf2::reader::callback {
     using otf2::reader::callback::event;
     using otf2::reader::callback::definition;
 private:
-    std::vector<Slot *> slots_;
-    std::vector<Communication *> communications_;
-    std::vector<CollectiveCommunicationEvent *> collectiveCommunications_;
-
     /**
-     * Vectors for building the slot datatypes. Key is the location of the events.
+     * @brief A slot that was entered but not yet left
      */
-    std::map<otf2::reference<otf2::definition::location>, std::vector<Slot::Builder> *> slotsBuilding;
+    struct PendingSlot {
+        otf2::chrono::duration start; /**< Time the slot was entered */
+        std::uint32_t region; /**< Index of the region of the slot */
+    };
 
     /**
-     * Vectors for building the blocking communication datatypes. Key is the location id of the sender.
+     * @brief The call stack of a location
      */
-    std::map<uint32_t, std::vector<CommunicationEvent *> *> pendingSends;
+    struct CallStack {
+        SlotStore *slots; /**< Store completed slots of the location are added to */
+        std::vector<PendingSlot> pending; /**< Slots that were entered but not yet left */
+    };
+
+    std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots_;
+    std::vector<CommunicationRecord> communicationRecords_;
 
     /**
-     * Vectors for building the blocking communication datatypes. Key is the location id of the receiver.
+     * Call stacks for building the slots. Key is the location of the events.
      */
-    std::map<uint32_t, std::vector<CommunicationEvent *> *> pendingReceives;
-
-    std::map<otf2::reference<otf2::definition::location>, CollectiveCommunicationEvent::Member::Builder> ongoingCollectiveCommunicationMembers;
-    CollectiveCommunicationEvent::Builder *ongoingCollectiveCommunication = nullptr;
+    std::map<otf2::reference<otf2::definition::location>, CallStack> slotsBuilding;
 
     /**
      * Vectors for building the non blocking communication datatypes. Key is the request id.
      */
     std::map<uint64_t, NonBlockingCommunicationEventBuilder> uncompletedRequests;
 
-    otf2::chrono::time_point program_start_;
-    otf2::chrono::time_point program_end_;
+    std::optional<otf2::chrono::time_point> program_start_;
+    std::optional<otf2::chrono::time_point> program_end_;
 
     otf2::reader::reader &rdr_;
+    DefinitionRegistry &registry_;
+
+    std::size_t shard_;
+    std::size_t shardCount_;
+
+    LoadProgress *progress_;
+    std::uint64_t eventsProcessed_ = 0;
+
+    /**
+     * Number of processed events after which the completed slots are published next. Doubled on every publication,
+     * so the slots are copied at most twice in total.
+     */
+    std::uint64_t nextPublication_ = 1 << 16;
 public:
     /**
      * @brief Creates a new instance of the ReaderCallbacks class
+     *
+     * Location groups are assigned to the shards round robin by their reference.
+     *
      * @param rdr Initialized reader
+     * @param registry Registry the definitions are interned in, filled by the first shard
+     * @param shard Index of the shard read by this instance
+     * @param shardCount Total number of shards the trace is split into
+     * @param progress Progress processed events are reported to and which may cancel reading, may be nullptr
      */
-    explicit ReaderCallbacks(otf2::reader::reader &rdr);
+    ReaderCallbacks(otf2::reader::reader &rdr, DefinitionRegistry &registry, std::size_t shard = 0,
+                    std::size_t shardCount = 1, LoadProgress *progress = nullptr);
+
+    void definition(const otf2::definition::location_group &group) override;
 
     void definition(const otf2::definition::location &loc) override;
 
+    void definition(const otf2::definition::region &region) override;
+
+    void definition(const otf2::definition::comm &comm) override;
+
+    void definition(const otf2::definition::inter_comm &comm) override;
+
     void event(const otf2::definition::location &location, const otf2::event::program_begin &event) override;
 
     void event(const otf2::definition::location &location, const otf2::event::program_end &event) override;
@@ -123,46 +183,47 @@ public:
 
 public:
     /**
-     * @brief Returns all read point to point communications
+     * @brief Returns all communication records of this shard in the order they were read
      *
      * The vector will only contain elements read by the reader when calling @link (otf2::reader::reader::read_events)
      *
-     * @return All read point to point communications
+     * @return All recorded communication events
      */
-    std::vector<Communication *> getCommunications();
-
+    [[nodiscard]] const std::vector<CommunicationRecord> &getCommunicationRecords() const;
 
     /**
-     * @brief Returns all read collective communications
+     * @brief Returns all read slots grouped by location group
      *
-     * The vector will only contain elements read by the reader when calling @link (otf2::reader::reader::read_events)
+     * The stores will only contain elements read by the reader when calling @link (otf2::reader::reader::read_events).
+     * Slots are in the order they were left, start and end times of the slots are absolute until they are made
+     * relative by the @ref TraceLoader.
      *
-     * @return All read collective communications
+     * @return All read slots
      */
-    std::vector<CollectiveCommunicationEvent *> getCollectiveCommunications();
+    std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &getSlots();
 
     /**
-     * @brief Returns all read slots
-     *
-     * The vector will only contain elements read by the reader when calling @link (otf2::reader::reader::read_events)
-     *
-     * @return All read slots
+     * @brief Returns the time the program started, if a program begin event was read by this shard
+     * @return Time the program started
      */
-    std::vector<Slot *> getSlots();
+    [[nodiscard]] std::optional<otf2::chrono::time_point> programStart() const;
 
     /**
-     * Duration of the trace
-     * @return Duration of the trace
+     * @brief Returns the time the program ended, if a program end event was read by this shard
+     * @return Time the program ended
      */
-    [[nodiscard]] otf2::chrono::duration duration() const;
+    [[nodiscard]] std::optional<otf2::chrono::time_point> programEnd() const;
 
 private:
-    template<typename T>
-    void communicationEvent(T *self, uint32_t matching,
-                            std::map<uint32_t, std::vector<CommunicationEvent *> *> &selfPending,
-                            std::map<uint32_t, std::vector<CommunicationEvent *> *> &matchingPending);
+    /**
+     * Reports an event to the progress and publishes the completed slots from time to time.
+     *
+     * @param location Location of the event
+     * @return Whether the event should be processed, false once loading was cancelled
+     */
+    bool process(const otf2::definition::location &location);
 
-    [[nodiscard]] otf2::chrono::duration relative(otf2::chrono::time_point) const;
+    [[nodiscard]] static otf2::chrono::duration absolute(otf2::chrono::time_point);
 };
 
 #endif //MOTIV_READERCALLBACKS_HPP
@@ -0,0 +1,325 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TraceCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <QDebug>
+#include <QSaveFile>
+
+namespace {
+    const char MAGIC[8] = {'M', 'O', 'T', 'I', 'V', 'C', 'C', 'H'};
+    const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    /**
+     * Header at the beginning of the cache file. It is followed by the location group table, the communication
+     * records, the region indices and finally the slot columns of all location groups. All sections are 8 byte aligned.
+     */
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrderMark;
+        std::uint64_t archiveSize;
+        std::int64_t archiveModified;
+        std::int64_t runtime;
+        std::uint64_t locationGroupCount;
+        std::uint64_t recordCount;
+        std::uint64_t regionCount;
+    };
+
+    /**
+     * Entry of the location group table. The slot columns of the location group start at @c offset: start times, end
+     * times, region indices and depths, @c slotCount values each.
+     */
+    struct LocationGroupEntry {
+        std::uint64_t ref;
+        std::uint64_t slotCount;
+        std::uint64_t offset;
+    };
+
+    /**
+     * Serialized CommunicationRecord, definitions are stored by their reference.
+     */
+    struct RecordEntry {
+        std::int64_t time;
+        std::int64_t start;
+        std::uint64_t location;
+        std::uint32_t communicator;
+        std::uint32_t peer;
+        std::uint32_t operation;
+        std::uint32_t tag;
+        std::uint8_t kind;
+        std::uint8_t communicatorKind; /**< 0 if there is no communicator, 1 for comm and 2 for inter_comm */
+        std::uint8_t padding[6];
+    };
+
+    static_assert(sizeof(Header) == 64);
+    static_assert(sizeof(LocationGroupEntry) == 24);
+    static_assert(sizeof(RecordEntry) == 48);
+    static_assert(sizeof(types::TraceTime) == sizeof(std::int64_t));
+
+    std::size_t align(std::size_t offset) {
+        return (offset + 7) & ~std::size_t(7);
+    }
+
+    const std::size_t SLOT_SIZE = 2 * sizeof(types::TraceTime) + 2 * sizeof(std::uint32_t);
+
+    std::size_t columnsSize(std::size_t slotCount) {
+        return slotCount * SLOT_SIZE;
+    }
+
+    /**
+     * Returns the size of @p count elements of @p elementSize bytes, throws if they cannot fit into @p limit bytes.
+     * Checked before multiplying, so corrupted counts cannot overflow.
+     */
+    std::size_t checkedSize(std::uint64_t count, std::size_t elementSize, std::size_t limit) {
+        if (count > limit / elementSize) {
+            throw std::out_of_range("Trace cache is truncated!");
+        }
+        return static_cast<std::size_t>(count) * elementSize;
+    }
+}
+
+TraceCache::TraceCache(const std::string &tracePath) :
+    tracePath_(tracePath),
+    cachePath_(std::filesystem::path(tracePath).replace_extension(".motivcache")) {}
+
+TraceCache::Fingerprint TraceCache::fingerprint() const {
+    // An OTF2 archive consists of the anchor file, the definitions file and a directory containing the event files
+    Fingerprint fingerprint;
+    auto add = [&fingerprint](const std::filesystem::directory_entry &entry) {
+        std::error_code error;
+        if (!entry.is_regular_file(error)) {
+            return;
+        }
+        fingerprint.size += entry.file_size(error);
+        auto modified = entry.last_write_time(error).time_since_epoch().count();
+        fingerprint.modified = std::max(fingerprint.modified, static_cast<std::int64_t>(modified));
+    };
+
+    std::error_code error;
+    add(std::filesystem::directory_entry(tracePath_, error));
+    add(std::filesystem::directory_entry(std::filesystem::path(tracePath_).replace_extension(".def"), error));
+
+    auto eventsPath = tracePath_.parent_path() / tracePath_.stem();
+    for (std::filesystem::recursive_directory_iterator it(eventsPath, error), end; !error && it != end;
+         it.increment(error)) {
+        add(*it);
+    }
+
+    return fingerprint;
+}
+
+bool TraceCache::open() {
+    auto file = std::make_shared<QFile>(QString::fromStdString(cachePath_.string()));
+    if (!file->open(QIODevice::ReadOnly) || file->size() < static_cast<qint64>(sizeof(Header))) {
+        return false;
+    }
+
+    auto data = file->map(0, file->size());
+    if (!data) {
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(&header, data, sizeof(Header));
+    auto expected = fingerprint();
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.byteOrderMark != BYTE_ORDER_MARK || header.archiveSize != expected.size ||
+        header.archiveModified != expected.modified) {
+        qInfo() << "ignoring outdated trace cache" << QString::fromStdString(cachePath_.string());
+        return false;
+    }
+
+    file_ = std::move(file);
+    data_ = data;
+    size_ = static_cast<std::size_t>(file_->size());
+    return true;
+}
+
+std::optional<TraceModel> TraceCache::read(const DefinitionRegistry &registry) const {
+    if (!data_) {
+        return std::nullopt;
+    }
+
+    try {
+        Header header{};
+        std::memcpy(&header, data_, sizeof(Header));
+
+        auto offset = sizeof(Header);
+        auto section = [this, &offset](std::size_t size) {
+            if (offset + size > size_) {
+                throw std::out_of_range("Trace cache is truncated!");
+            }
+            auto begin = data_ + offset;
+            offset = align(offset + size);
+            return begin;
+        };
+
+        auto groups = reinterpret_cast<const LocationGroupEntry *>(
+            section(checkedSize(header.locationGroupCount, sizeof(LocationGroupEntry), size_)));
+        auto records = reinterpret_cast<const RecordEntry *>(
+            section(checkedSize(header.recordCount, sizeof(RecordEntry), size_)));
+        auto regions = reinterpret_cast<const std::uint32_t *>(
+            section(checkedSize(header.regionCount, sizeof(std::uint32_t), size_)));
+
+        // Slots are painted by looking their region up, so the mapped region indices must refer to defined regions
+        auto checkRegion = [&registry](std::uint32_t regionIndex) {
+            if (!registry.hasRegion(regionIndex)) {
+                throw std::out_of_range("Trace cache refers to an undefined region!");
+            }
+        };
+
+        TraceModel model;
+        model.runtime = otf2::chrono::duration(header.runtime);
+        model.regions.assign(regions, regions + header.regionCount);
+        std::for_each(model.regions.begin(), model.regions.end(), checkRegion);
+
+        // The slot stores refer to the mapped columns, the mapping is kept alive by the stores
+        std::shared_ptr<const void> owner = file_;
+        for (std::size_t i = 0; i < header.locationGroupCount; ++i) {
+            const auto &group = groups[i];
+            if (group.offset > size_ || group.offset % 8 != 0) {
+                throw std::out_of_range("Trace cache is truncated!");
+            }
+            checkedSize(group.slotCount, SLOT_SIZE, size_ - group.offset);
+
+            auto n = static_cast<std::size_t>(group.slotCount);
+            auto starts = reinterpret_cast<const types::TraceTime *>(data_ + group.offset);
+            auto ends = starts + n;
+            auto regionIndices = reinterpret_cast<const std::uint32_t *>(ends + n);
+            auto depths = regionIndices + n;
+            std::for_each(regionIndices, regionIndices + n, checkRegion);
+            // A call stack cannot be deeper than the number of slots of its location group
+            if (std::any_of(depths, depths + n, [n](std::uint32_t depth) { return depth >= n; })) {
+                throw std::out_of_range("Trace cache contains invalid call stack depths!");
+            }
+
+            auto locationGroup = registry.locationGroup(
+                otf2::reference<otf2::definition::location_group>(static_cast<std::uint32_t>(group.ref)));
+            model.slots.insert({locationGroup, SlotStore(&registry, n, starts, ends, regionIndices, depths, owner)});
+        }
+
+        model.communicationRecords.reserve(header.recordCount);
+        for (std::size_t i = 0; i < header.recordCount; ++i) {
+            const auto &entry = records[i];
+
+            types::communicator *communicator = nullptr;
+            if (entry.communicatorKind == 1) {
+                communicator = registry.comm(otf2::reference<otf2::definition::comm>(entry.communicator));
+            } else if (entry.communicatorKind == 2) {
+                communicator = registry.interComm(otf2::reference<otf2::definition::inter_comm>(entry.communicator));
+            }
+
+            model.communicationRecords.push_back(
+                {static_cast<CommunicationRecord::Kind>(entry.kind),
+                 otf2::chrono::duration(entry.time),
+                 otf2::chrono::duration(entry.start),
+                 registry.location(otf2::reference<otf2::definition::location>(entry.location)),
+                 communicator,
+                 entry.peer,
+                 static_cast<otf2::collective_type>(entry.operation),
+                 entry.tag});
+        }
+
+        return model;
+    } catch (const std::out_of_range &e) {
+        qWarning() << "ignoring corrupted trace cache" << QString::fromStdString(cachePath_.string()) << e.what();
+        return std::nullopt;
+    }
+}
+
+bool TraceCache::write(const TraceModel &model) const {
+    QSaveFile file(QString::fromStdString(cachePath_.string()));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "cannot write trace cache" << file.errorString();
+        return false;
+    }
+
+    auto fingerprint = this->fingerprint();
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.archiveSize = fingerprint.size;
+    header.archiveModified = fingerprint.modified;
+    header.runtime = model.runtime.count();
+    header.locationGroupCount = model.slots.size();
+    header.recordCount = model.communicationRecords.size();
+    header.regionCount = model.regions.size();
+
+    std::size_t written = 0;
+    auto writeBytes = [&file, &written](const void *data, std::size_t size) {
+        file.write(reinterpret_cast<const char *>(data), static_cast<qint64>(size));
+        written += size;
+    };
+    auto pad = [&writeBytes, &written]() {
+        const char zeros[8] = {};
+        writeBytes(zeros, align(written) - written);
+    };
+
+    writeBytes(&header, sizeof(Header));
+
+    auto offset = align(sizeof(Header) + model.slots.size() * sizeof(LocationGroupEntry));
+    offset = align(offset + model.communicationRecords.size() * sizeof(RecordEntry));
+    offset = align(offset + model.regions.size() * sizeof(std::uint32_t));
+    for (const auto &[locationGroup, slots]: model.slots) {
+        LocationGroupEntry entry{locationGroup->ref().get(), slots.size(), offset};
+        writeBytes(&entry, sizeof(LocationGroupEntry));
+        offset += columnsSize(slots.size());
+    }
+    pad();
+
+    for (const auto &record: model.communicationRecords) {
+        RecordEntry entry{};
+        entry.time = record.time.count();
+        entry.start = record.start.count();
+        entry.location = record.location->ref().get();
+        entry.peer = record.peer;
+        entry.operation = static_cast<std::uint32_t>(record.operation);
+        entry.tag = record.tag;
+        entry.kind = static_cast<std::uint8_t>(record.kind);
+        if (record.communicator) {
+            entry.communicatorKind = static_cast<std::uint8_t>(record.communicator->index() + 1);
+            entry.communicator = std::visit([](const auto &comm) {
+                return static_cast<std::uint32_t>(comm.ref().get());
+            }, *record.communicator);
+        }
+        writeBytes(&entry, sizeof(RecordEntry));
+    }
+    pad();
+
+    writeBytes(model.regions.data(), model.regions.size() * sizeof(std::uint32_t));
+    pad();
+
+    for (const auto &item: model.slots) {
+        const auto &slots = item.second;
+        writeBytes(slots.starts().data(), slots.size() * sizeof(types::TraceTime));
+        writeBytes(slots.ends().data(), slots.size() * sizeof(types::TraceTime));
+        writeBytes(slots.regionIndices().data(), slots.size() * sizeof(std::uint32_t));
+        writeBytes(slots.depths().data(), slots.size() * sizeof(std::uint32_t));
+    }
+
+    if (!file.commit()) {
+        qWarning() << "cannot write trace cache" << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,104 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_TRACECACHE_HPP
+#define MOTIV_TRACECACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <QFile>
+
+#include "TraceLoader.hpp"
+
+/**
+ * @brief Binary cache of the model of a trace
+ *
+ * The cache is stored as a sidecar file next to the anchor file of the trace, e.g. `traces.motivcache` for
+ * `traces.otf2`. It contains the fully built model as flat arrays: the columns of the slots of each location group,
+ * the sorted communication records and the regions occurring in the trace. Definitions are not cached, they are
+ * referred to by their OTF2 reference and have to be read from the trace.
+ *
+ * The cache is memory mapped when it is read. The slot stores refer to the mapped columns directly, so reading the
+ * cache only costs the page faults of the data that is actually accessed.
+ *
+ * A cache is only used if it was written by the same format version and the total size and the latest modification
+ * time of the files of the trace archive did not change since the cache was written.
+ */
+class TraceCache {
+public:
+    /**
+     * @brief Version of the cache format, caches of other versions are ignored
+     */
+    static constexpr std::uint32_t VERSION = 2;
+
+    /**
+     * @brief Creates a new instance of the TraceCache class
+     *
+     * @param tracePath Path to the anchor file of the trace
+     */
+    explicit TraceCache(const std::string &tracePath);
+
+    /**
+     * @brief Maps the cache file into memory and checks whether it is valid for the trace
+     *
+     * @return Whether a valid cache exists
+     */
+    [[nodiscard]] bool open();
+
+    /**
+     * @brief Reads the model from the opened cache
+     *
+     * @param registry Registry containing the definitions of the trace, the model refers to them
+     * @return The cached model, empty if the cache is corrupted or does not match the definitions
+     */
+    [[nodiscard]] std::optional<TraceModel> read(const DefinitionRegistry &registry) const;
+
+    /**
+     * @brief Writes a model to the cache file
+     *
+     * Failing to write the cache, e.g. because the directory of the trace is read only, is not an error. The trace is
+     * just not cached.
+     *
+     * @param model The model to be cached
+     * @return Whether the cache was written
+     */
+    bool write(const TraceModel &model) const;
+
+private:
+    /**
+     * @brief Identifies the state of the trace archive
+     */
+    struct Fingerprint {
+        std::uint64_t size = 0; /**< Total size of all files of the archive */
+        std::int64_t modified = 0; /**< Latest modification time of all files of the archive */
+    };
+
+    [[nodiscard]] Fingerprint fingerprint() const;
+
+private:
+    std::filesystem::path tracePath_;
+    std::filesystem::path cachePath_;
+
+    std::shared_ptr<QFile> file_;
+    const uchar *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+#endif //MOTIV_TRACECACHE_HPP
@@ -0,0 +1,383 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TraceLoader.hpp"
+#include "TraceCache.hpp"
+#include "src/models/communication/BlockingSendEvent.hpp"
+#include "src/models/communication/BlockingReceivEevent.hpp"
+#include "src/models/communication/NonBlockingSendEvent.hpp"
+#include "src/models/communication/NonBlockingReceiveEvent.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <QDebug>
+#include <memory>
+#include <thread>
+#include <utility>
+
+/**
+ * Runs @p fn for each index in [0, n) on its own thread and waits for all of them to finish.
+ * The first exception thrown by any of the threads is rethrown.
+ */
+template<typename F>
+static void parallelFor(std::size_t n, F fn) {
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        threads.emplace_back([&fn, &errors, i] {
+            try {
+                fn(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    for (const auto &error: errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+TraceLoader::TraceLoader(std::string filepath, const DefinitionRegistry::KindColors &kindColors, std::size_t jobs) :
+    filepath_(std::move(filepath)),
+    kindColors_(kindColors),
+    jobs_(jobs) {
+    if (jobs_ == 0) {
+        jobs_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+FileTrace *TraceLoader::load() {
+    progress_.setStage(LoadProgress::ReadingDefinitions);
+
+    auto registry = std::make_shared<DefinitionRegistry>(kindColors_);
+    std::optional<TraceModel> model;
+
+    TraceCache cache(filepath_);
+    if (cache.open()) {
+        readDefinitions(*registry);
+        model = cache.read(*registry);
+    }
+
+    if (!model) {
+        registry = std::make_shared<DefinitionRegistry>(kindColors_);
+        model = readTrace(registry);
+        if (progress_.cancelled()) {
+            // Previews shown so far keep the registry alive
+            return nullptr;
+        }
+        cache.write(*model);
+    }
+
+    progress_.setStage(LoadProgress::Linking);
+
+    // Link communications in the order the events would have been read by a single reader
+    for (const auto &record: model->communicationRecords) {
+        link(record);
+    }
+
+    std::sort(this->communications_.begin(), this->communications_.end(),
+              [](Communication *rhs, Communication *lhs) {
+                  return rhs->getStartEvent()->getStartTime() < lhs->getStartEvent()->getStartTime();
+              });
+    std::stable_sort(this->collectiveCommunications_.begin(), this->collectiveCommunications_.end(),
+                     [](CollectiveCommunicationEvent *lhs, CollectiveCommunicationEvent *rhs) {
+                         return lhs->getStartTime() < rhs->getStartTime();
+                     });
+
+    dropUnmatched();
+
+    progress_.setStage(LoadProgress::Done);
+    return new FileTrace(model->slots, communications_, collectiveCommunications_, model->runtime,
+                         std::move(model->regions), registry);
+}
+
+LoadProgress &TraceLoader::progress() {
+    return progress_;
+}
+
+FileTrace *TraceLoader::preview() const {
+    std::shared_ptr<DefinitionRegistry> registry;
+    {
+        std::lock_guard lock(previewMutex_);
+        registry = previewRegistry_;
+    }
+    if (!registry) {
+        return nullptr;
+    }
+
+    // Every location group gets a row, even if none of its slots have been completed yet
+    std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots;
+    for (const auto &locationGroup: registry->locationGroups()) {
+        slots.try_emplace(locationGroup, registry.get());
+    }
+
+    auto partial = progress_.partialSlots();
+
+    // The program begin might not have been read yet, the earliest slot is the best guess then
+    otf2::chrono::duration offset(0);
+    if (partial.programStart) {
+        offset = partial.programStart->time_since_epoch();
+    } else {
+        auto first = otf2::chrono::duration::max();
+        for (const auto &[locationGroup, store]: partial.slots) {
+            for (const auto &start: store.starts()) {
+                first = std::min(first, start);
+            }
+        }
+        offset = partial.slots.empty() ? offset : first;
+    }
+
+    // The runtime must not be 0, views divide by it
+    otf2::chrono::duration runtime(1);
+    std::vector<bool> occurring;
+    for (auto &[locationGroup, store]: partial.slots) {
+        store.shift(-offset);
+        store.sortByStart();
+        for (const auto &end: store.ends()) {
+            runtime = std::max(runtime, end);
+        }
+        for (const auto &region: store.regionIndices()) {
+            if (region >= occurring.size()) {
+                occurring.resize(region + 1);
+            }
+            occurring[region] = true;
+        }
+        slots.insert_or_assign(locationGroup, std::move(store));
+    }
+
+    // Colors are resolved by the GUI thread once the preview is shown
+    std::vector<std::uint32_t> regions;
+    for (std::size_t region = 0; region < occurring.size(); ++region) {
+        if (occurring[region]) {
+            regions.push_back(static_cast<std::uint32_t>(region));
+        }
+    }
+
+    // Communications are only linked once all events have been read
+    std::vector<Communication *> communications;
+    std::vector<CollectiveCommunicationEvent *> collectiveCommunications;
+    return new FileTrace(slots, communications, collectiveCommunications, runtime, std::move(regions), registry);
+}
+
+void TraceLoader::readDefinitions(DefinitionRegistry &registry) const {
+    otf2::reader::reader reader(filepath_);
+    ReaderCallbacks callbacks(reader, registry);
+    reader.set_callback(callbacks);
+    reader.read_definitions();
+}
+
+TraceModel TraceLoader::readTrace(const std::shared_ptr<DefinitionRegistry> &registry) {
+    auto shardCount = jobs_;
+
+    std::vector<std::unique_ptr<otf2::reader::reader>> readers;
+    std::vector<std::unique_ptr<ReaderCallbacks>> callbacks;
+    for (std::size_t shard = 0; shard < shardCount; ++shard) {
+        readers.push_back(std::make_unique<otf2::reader::reader>(filepath_));
+        callbacks.push_back(
+            std::make_unique<ReaderCallbacks>(*readers.back(), *registry, shard, shardCount, &progress_));
+        readers.back()->set_callback(*callbacks.back());
+    }
+
+    // The registry is filled while reading the definitions, all definitions have to be read before any shard
+    // starts reading events
+    parallelFor(shardCount, [&readers](std::size_t shard) {
+        readers[shard]->read_definitions();
+    });
+    progress_.setLocations(*registry, filepath_);
+    progress_.setStage(LoadProgress::ReadingEvents);
+    {
+        std::lock_guard lock(previewMutex_);
+        previewRegistry_ = registry;
+    }
+
+    parallelFor(shardCount, [&readers](std::size_t shard) {
+        readers[shard]->read_events();
+    });
+
+    if (progress_.cancelled()) {
+        return {};
+    }
+
+    // Shards only know about the program begin and end events of their own locations
+    std::optional<otf2::chrono::time_point> programStart;
+    std::optional<otf2::chrono::time_point> programEnd;
+    for (const auto &shard: callbacks) {
+        if (shard->programStart() && (!programStart || *shard->programStart() < *programStart)) {
+            programStart = shard->programStart();
+        }
+        if (shard->programEnd() && (!programEnd || *shard->programEnd() > *programEnd)) {
+            programEnd = shard->programEnd();
+        }
+    }
+    auto offset = programStart ? programStart->time_since_epoch() : otf2::chrono::duration(0);
+
+    // Make slots relative to the program start and sort them by their start time. Shards contain disjoint location
+    // groups, so this can be done for each shard independently.
+    std::vector<otf2::chrono::duration> shardEnds(shardCount, otf2::chrono::duration(0));
+    std::vector<std::vector<bool>> shardRegions(shardCount);
+    parallelFor(shardCount, [&callbacks, &shardEnds, &shardRegions, offset](std::size_t shard) {
+        for (auto &[locationGroup, slots]: callbacks[shard]->getSlots()) {
+            slots.shift(-offset);
+            slots.sortByStart();
+
+            if (!slots.empty()) {
+                const auto &ends = slots.ends();
+                shardEnds[shard] = std::max(shardEnds[shard], *std::max_element(ends.begin(), ends.end()));
+            }
+
+            auto &regions = shardRegions[shard];
+            for (const auto &region: slots.regionIndices()) {
+                if (region >= regions.size()) {
+                    regions.resize(region + 1);
+                }
+                regions[region] = true;
+            }
+        }
+    });
+
+    TraceModel model;
+    for (const auto &shard: callbacks) {
+        model.slots.merge(shard->getSlots());
+    }
+
+    std::vector<bool> regions;
+    for (const auto &shardRegion: shardRegions) {
+        regions.resize(std::max(regions.size(), shardRegion.size()));
+        for (std::size_t region = 0; region < shardRegion.size(); ++region) {
+            if (shardRegion[region]) {
+                regions[region] = true;
+            }
+        }
+    }
+    for (std::size_t region = 0; region < regions.size(); ++region) {
+        if (regions[region]) {
+            model.regions.push_back(static_cast<std::uint32_t>(region));
+        }
+    }
+
+    // Records of all shards in the order the events would have been read by a single reader
+    for (const auto &shard: callbacks) {
+        const auto &records = shard->getCommunicationRecords();
+        model.communicationRecords.insert(model.communicationRecords.end(), records.begin(), records.end());
+    }
+    std::stable_sort(model.communicationRecords.begin(), model.communicationRecords.end(),
+                     [](const CommunicationRecord &lhs, const CommunicationRecord &rhs) {
+                         return lhs.time < rhs.time;
+                     });
+    for (auto &record: model.communicationRecords) {
+        record.time -= offset;
+        record.start -= offset;
+    }
+
+    if (programEnd) {
+        model.runtime = programEnd->time_since_epoch() - offset;
+    } else {
+        model.runtime = *std::max_element(shardEnds.begin(), shardEnds.end());
+    }
+
+    return model;
+}
+
+void TraceLoader::communicationEvent(CommunicationEvent *self, MessageMatcher::Side side,
+                                     const CommunicationRecord &record) {
+    // Ranks are identified by the reference of their location, the peer of the record is the rank of the partner
+    auto rank = static_cast<std::uint64_t>(self->getLocation()->ref().get());
+    MessageMatcher::Key key{record.communicator, side == MessageMatcher::Send ? rank : record.peer,
+                            side == MessageMatcher::Send ? record.peer : rank, record.tag};
+
+    if (auto matchingEvent = pendingMessages.match(side, key, self)) {
+        auto communication = side == MessageMatcher::Send ? new Communication(self, matchingEvent)
+                                                          : new Communication(matchingEvent, self);
+        communications_.push_back(communication);
+    }
+}
+
+void TraceLoader::dropUnmatched() {
+    auto sends = pendingMessages.pending(MessageMatcher::Send);
+    auto receives = pendingMessages.pending(MessageMatcher::Receive);
+    if (sends > 0 || receives > 0) {
+        qWarning() << "ignoring" << sends << "sends and" << receives << "receives without matching partner";
+    }
+
+    pendingMessages.forEachPending([](MessageMatcher::Side, const MessageMatcher::Key &, CommunicationEvent *event) {
+        delete event;
+    });
+    pendingMessages.clear();
+}
+
+void TraceLoader::link(const CommunicationRecord &record) {
+    auto start = record.start;
+    auto time = record.time;
+
+    switch (record.kind) {
+        case CommunicationRecord::BlockingSend: {
+            auto ev = new BlockingSendEvent(time, record.location, record.communicator);
+            communicationEvent(ev, MessageMatcher::Send, record);
+            break;
+        }
+        case CommunicationRecord::BlockingReceive: {
+            auto ev = new BlockingReceiveEvent(time, record.location, record.communicator);
+            communicationEvent(ev, MessageMatcher::Receive, record);
+            break;
+        }
+        case CommunicationRecord::NonBlockingSend: {
+            auto ev = new NonBlockingSendEvent(start, time, record.location, record.communicator);
+            communicationEvent(ev, MessageMatcher::Send, record);
+            break;
+        }
+        case CommunicationRecord::NonBlockingReceive: {
+            auto ev = new NonBlockingReceiveEvent(start, time, record.location, record.communicator);
+            communicationEvent(ev, MessageMatcher::Receive, record);
+            break;
+        }
+        case CommunicationRecord::CollectiveBegin:
+            this->ongoingCollectiveCommunicationMembers.insert({record.location->ref().get(), start});
+            break;
+        case CommunicationRecord::CollectiveEnd: {
+            if (ongoingCollectiveCommunicationRecord == nullptr) {
+                ongoingCollectiveCommunicationRecord = &record;
+            }
+
+            auto memberIt = ongoingCollectiveCommunicationMembers.find(record.location->ref().get());
+            auto memberStart = memberIt != ongoingCollectiveCommunicationMembers.end() ? memberIt->second : time;
+            ongoingCollectiveCommunication.push_back(
+                new CollectiveCommunicationEvent::Member(memberStart, time, record.location));
+            ongoingCollectiveCommunicationMembers.erase(record.location->ref().get());
+
+            // If the map is now empty, all ranks have completed the collective operation and the communication event can be build
+            if (ongoingCollectiveCommunicationMembers.empty()) {
+                auto event = new CollectiveCommunicationEvent(ongoingCollectiveCommunication,
+                                                              ongoingCollectiveCommunicationRecord->location,
+                                                              ongoingCollectiveCommunicationRecord->communicator,
+                                                              ongoingCollectiveCommunicationRecord->operation,
+                                                              ongoingCollectiveCommunicationRecord->peer);
+                collectiveCommunications_.push_back(event);
+                ongoingCollectiveCommunication.clear();
+                ongoingCollectiveCommunicationRecord = nullptr;
+            }
+            break;
+        }
+    }
+}
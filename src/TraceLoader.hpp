@@ -0,0 +1,182 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_TRACELOADER_HPP
+#define MOTIV_TRACELOADER_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "LoadProgress.hpp"
+#include "MessageMatcher.hpp"
+#include "ReaderCallbacks.hpp"
+#include "src/models/Filetrace.hpp"
+
+/**
+ * @brief Model of a trace as built by the TraceLoader before the communications are linked
+ *
+ * This is also what is stored in the cache of a trace, see @ref TraceCache.
+ */
+struct TraceModel {
+    /**
+     * Slots grouped by location group, sorted by their start time
+     */
+    std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots;
+
+    /**
+     * Communication records relative to the program start, in the order they are linked
+     */
+    std::vector<CommunicationRecord> communicationRecords;
+
+    /**
+     * Indices of all regions occurring in the slots
+     */
+    std::vector<std::uint32_t> regions;
+
+    /**
+     * Runtime of the trace
+     */
+    otf2::chrono::duration runtime{0};
+};
+
+/**
+ * @brief Loads an OTF2 trace with several readers in parallel
+ *
+ * The location groups (MPI ranks) of the trace are split into shards. Each shard is read by its own
+ * otf2::reader::reader on a separate thread and builds its own slots. Afterwards, the shards are merged: slots are
+ * grouped per shard in parallel, the communication records of all shards are linked into communications and
+ * collective communications in the global order of the events.
+ *
+ * The model built from the events is stored in a cache next to the trace. When the trace is opened again, only the
+ * definitions are read and the model is taken from the cache, see @ref TraceCache.
+ *
+ * While the events are read, the progress per location is reported to a @ref LoadProgress. The slots read so far can
+ * be displayed by building a @ref preview() in the meantime.
+ */
+class TraceLoader {
+public:
+    /**
+     * @brief Creates a new instance of the TraceLoader class
+     *
+     * @param filepath Path to the anchor file of the trace
+     * @param kindColors Default colors of the slot kinds, shown until the colors of the regions are resolved
+     * @param jobs Number of readers (threads) used for loading. If 0, the number of hardware threads is used.
+     */
+    TraceLoader(std::string filepath, const DefinitionRegistry::KindColors &kindColors, std::size_t jobs = 0);
+
+    /**
+     * @brief Reads the entire trace
+     *
+     * The caller takes ownership of the returned trace. Loading may be run on a separate thread, it reports its
+     * progress to and can be cancelled via @ref progress().
+     *
+     * @return The trace read from the file, nullptr if loading was cancelled
+     */
+    FileTrace *load();
+
+    /**
+     * @brief Returns the progress of loading the trace
+     *
+     * The progress may be accessed from any thread while the trace is loaded.
+     *
+     * @return The progress of loading
+     */
+    LoadProgress &progress();
+
+    /**
+     * @brief Builds a trace of the slots read so far
+     *
+     * May be called from any thread while the events are read. The preview contains a row for every location group
+     * but no communications. It shares its definitions with the trace eventually returned by @ref load(), so it stays
+     * valid if loading is cancelled or the loaded trace is deleted first.
+     *
+     * The caller takes ownership of the returned trace.
+     *
+     * @return The partially read trace, nullptr if the definitions have not been read yet
+     */
+    [[nodiscard]] FileTrace *preview() const;
+
+private:
+    /**
+     * Reads the definitions of the trace with a single reader.
+     *
+     * @param registry Registry the definitions are interned in
+     */
+    void readDefinitions(DefinitionRegistry &registry) const;
+
+    /**
+     * Reads definitions and events of the trace with several readers in parallel.
+     *
+     * @param registry Registry the definitions are interned in, shared with the previews
+     * @return The model of the trace
+     */
+    TraceModel readTrace(const std::shared_ptr<DefinitionRegistry> &registry);
+
+    /**
+     * Links a single communication record with the previously replayed ones.
+     *
+     * @param record The record to be linked, times are relative to the program start
+     */
+    void link(const CommunicationRecord &record);
+
+    /**
+     * Matches a point to point event with a pending event of the other side or queues it.
+     *
+     * @param self The event to be matched
+     * @param side Whether the event sends or receives
+     * @param record The record of the event
+     */
+    void communicationEvent(CommunicationEvent *self, MessageMatcher::Side side, const CommunicationRecord &record);
+
+    /**
+     * Reports and deletes the point to point events that were never matched.
+     */
+    void dropUnmatched();
+
+private:
+    std::string filepath_;
+    DefinitionRegistry::KindColors kindColors_;
+    std::size_t jobs_;
+
+    LoadProgress progress_;
+
+    /**
+     * Registry previews refer to, set once all definitions have been read. Guarded by previewMutex_.
+     */
+    std::shared_ptr<DefinitionRegistry> previewRegistry_;
+    mutable std::mutex previewMutex_;
+
+    std::vector<Communication *> communications_;
+    std::vector<CollectiveCommunicationEvent *> collectiveCommunications_;
+
+    /**
+     * Sends and receives waiting for their partner
+     */
+    MessageMatcher pendingMessages;
+
+    /**
+     * Start times of members that entered but not yet completed a collective operation. Key is the location of the
+     * member.
+     */
+    std::map<otf2::reference<otf2::definition::location>, otf2::chrono::duration> ongoingCollectiveCommunicationMembers;
+    std::vector<CollectiveCommunicationEvent::Member *> ongoingCollectiveCommunication;
+    const CommunicationRecord *ongoingCollectiveCommunicationRecord = nullptr;
+};
+
+#endif //MOTIV_TRACELOADER_HPP
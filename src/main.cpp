@@ -50,6 +50,8 @@ int main(int argc, char *argv[])
     QCommandLineOption versionOption = parser.addVersionOption();
 	QCommandLineOption testrunOption("t", QCoreApplication::translate("main", "#todo: fitting descr?"), "file");
 	parser.addOption(testrunOption);
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", QCoreApplication::translate("main", "number of threads used to load the trace (default: number of hardware threads)"), "jobs", "0");
+    parser.addOption(jobsOption);
     parser.addPositionalArgument("file", QCoreApplication::translate("main", "filepath of the .otf2 trace file to open"), "[file]");
 
     parser.process(app);
@@ -59,6 +61,8 @@ int main(int argc, char *argv[])
         return EXIT_SUCCESS;
     }
 
+    auto loadJobs = parser.value(jobsOption).toUInt();
+
     QStringList positionalArguments = parser.positionalArguments();
     QString filepath;
     if (!positionalArguments.isEmpty()) {
@@ -68,7 +72,7 @@ int main(int argc, char *argv[])
     // Test run without window display
 	if (parser.isSet(testrunOption)){     
 		testRun = true;
-        auto dummyWindow = new MainWindow(parser.value(testrunOption));
+        auto dummyWindow = new MainWindow(parser.value(testrunOption), loadJobs);
         app.quit();
         std::cout << "%application in general%" << appTimer.elapsed() << "%ms%";
         return EXIT_SUCCESS;
@@ -76,7 +80,7 @@ int main(int argc, char *argv[])
 
     RecentFilesDialog recentFilesDialog(&filepath);
     if(!filepath.isEmpty() || recentFilesDialog.exec() == QDialog::Accepted) {
-        auto mainWindow = new MainWindow(filepath);
+        auto mainWindow = new MainWindow(filepath, loadJobs);
         qInfo() << "motiv ready";
         mainWindow->show();
     } else {
@@ -18,6 +18,9 @@
 #ifndef MOTIV_BUILDER_HPP
 #define MOTIV_BUILDER_HPP
 
+#include <optional>
+#include <stdexcept>
+
 // Makros allowing performing some operation on each element of a list
 // Code from https://github.com/swansontec/map-macro/blob/master/map.h
 #define EVAL0(...) __VA_ARGS__
@@ -63,29 +66,31 @@
 
 /**
  * Macro to add a field to a BUILDER
+ *
+ * The field is stored inline in a std::optional, setting it does not allocate.
  */
 #define BUILDER_FIELD(type, name)                                       \
 private:                                                                \
-    std::shared_ptr<type> name ## _;                                    \
-    void check_ ## name() {                                             \
+    std::optional<type> name ## _;                                      \
+    void check_ ## name() const {                                       \
         if(!name ## _)                                                  \
         throw std::invalid_argument("Field '"#name"'must be set!"); }   \
 public:                                                                 \
-    Builder * name(type & s) {                                          \
-        name ## _ = std::make_shared<type>(s);                          \
+    Builder * name(type const & s) {                                    \
+        name ## _ = s;                                                  \
         return this;                                                    \
     }                                                                   \
-    std::shared_ptr<type> name() {                                                     \
+    const std::optional<type> &name() const {                           \
         return name ## _;                                               \
     }
 
 #define BUILDER_OPTIONAL_FIELD(type, name)                              \
 private:                                                                \
-    std::shared_ptr<type> name ## _;                                    \
+    std::optional<type> name ## _;                                      \
 public:                                                                 \
     type name() const { return *name ## _; }                            \
-    Builder * name(type & s) {                                          \
-        name ## _ = std::make_shared<type>(s);                          \
+    Builder * name(type const & s) {                                    \
+        name ## _ = s;                                                  \
         return this;                                                    \
     }
 
@@ -112,27 +117,27 @@ public:                                                                 \
 class Builder : public builder<type> {                  \
 public:                                                 \
     Builder() = default;                                \
-    type build(){                                       \
+    [[nodiscard]] type build() const {                  \
         MAP(BUILDER_CHECK, __VA_ARGS__)                 \
         return {MAP_LIST(BUILDER_DREF, __VA_ARGS__)};   \
     };                                                  \
     content                                             \
 };
 
+/**
+ * @brief Base of all builders generated by BUILDER
+ *
+ * Builders are plain values without virtual functions, their fields are kept inline and build() is resolved at compile
+ * time. The compiler checks that the fields passed to build() exist and fit the constructor of the target object. Only
+ * whether all required fields have been set is checked when building, as builders are usually filled over several
+ * events: if one has not been set, an @code std::invalid_argument_exception @endcode is thrown.
+ *
+ * @tparam T Type of the target object
+ */
 template<typename T>
 class builder {
 public:
-    virtual ~builder() = default;
-
-    /**
-     * @brief Build the target object
-     *
-     * Before constructing the target object, all fields are checked.
-     * If one has not been set, an @code std::invalid_argument_exception @endcode is thrown.
-     *
-     * @return Instance of target object
-     */
-    virtual T build() = 0;
+    using target_type = T;
 };
 
 #endif //MOTIV_BUILDER_HPP
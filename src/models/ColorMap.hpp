@@ -25,6 +25,8 @@
 
 /**
  * @brief Singleton class for managing a list of unique colors associated with function names.
+ *
+ * Colors are only resolved on the GUI thread when a trace is shown, see DefinitionRegistry::resolveColor().
  */
 class ColorMap {
 private:    
@@ -0,0 +1,169 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DefinitionRegistry.hpp"
+
+#include <stdexcept>
+
+DefinitionRegistry::DefinitionRegistry(const KindColors &kindColors) :
+    kindColors_(kindColors) {}
+
+template<typename T, typename D>
+void DefinitionRegistry::insert(std::vector<std::unique_ptr<T>> &table, std::size_t ref, const D &definition) {
+    // References are usually dense, so a vector indexed by the reference is sufficient
+    if (ref >= table.size()) {
+        table.resize(ref + 1);
+    }
+    table[ref] = std::make_unique<T>(definition);
+}
+
+template<typename T>
+T *DefinitionRegistry::lookup(const std::vector<std::unique_ptr<T>> &table, std::size_t ref) {
+    if (ref >= table.size() || !table[ref]) {
+        throw std::out_of_range("Reference to an undefined definition!");
+    }
+    return table[ref].get();
+}
+
+template<typename T>
+std::vector<T *> DefinitionRegistry::all(const std::vector<std::unique_ptr<T>> &table) {
+    std::vector<T *> definitions;
+    for (const auto &definition: table) {
+        if (definition) {
+            definitions.push_back(definition.get());
+        }
+    }
+    return definitions;
+}
+
+void DefinitionRegistry::add(const otf2::definition::location_group &locationGroup) {
+    insert(locationGroups_, locationGroup.ref().get(), locationGroup);
+}
+
+void DefinitionRegistry::add(const otf2::definition::location &location) {
+    insert(locations_, location.ref().get(), location);
+}
+
+void DefinitionRegistry::add(const otf2::definition::region &region) {
+    auto ref = region.ref().get();
+    insert(regions_, ref, region);
+
+    // Kinds and colors are determined by the name, so the name is only inspected here
+    auto name = region.name().str();
+    auto kind = Slot::kindOf(&region);
+    auto [entry, added] = paletteIndices_.try_emplace(name, static_cast<std::uint32_t>(palette_.size()));
+    auto paletteIndex = entry->second;
+    if (added) {
+        // Until the color is resolved, previews of a trace still being loaded show the default color of the kind
+        auto color = kind == MPI ? kindColors_.mpi : kind == OpenMP ? kindColors_.openMp : kindColors_.plain;
+        palette_.push_back({color, ref, false});
+    }
+    if (ref >= regionAttributes_.size()) {
+        regionAttributes_.resize(ref + 1);
+    }
+    regionAttributes_[ref] = {kind, Slot::priorityOf(kind), paletteIndex, QString::fromStdString(name)};
+}
+
+void DefinitionRegistry::add(const otf2::definition::comm &comm) {
+    insert(comms_, comm.ref().get(), comm);
+}
+
+void DefinitionRegistry::add(const otf2::definition::inter_comm &comm) {
+    insert(interComms_, comm.ref().get(), comm);
+}
+
+otf2::definition::location_group *
+DefinitionRegistry::locationGroup(otf2::reference<otf2::definition::location_group> ref) const {
+    return lookup(locationGroups_, ref.get());
+}
+
+otf2::definition::location *DefinitionRegistry::location(otf2::reference<otf2::definition::location> ref) const {
+    return lookup(locations_, ref.get());
+}
+
+otf2::definition::region *DefinitionRegistry::region(otf2::reference<otf2::definition::region> ref) const {
+    return lookup(regions_, ref.get());
+}
+
+types::communicator *DefinitionRegistry::communicator(const types::communicator &comm) const {
+    if (std::holds_alternative<otf2::definition::comm>(comm)) {
+        return this->comm(std::get<otf2::definition::comm>(comm).ref());
+    }
+    return interComm(std::get<otf2::definition::inter_comm>(comm).ref());
+}
+
+types::communicator *DefinitionRegistry::comm(otf2::reference<otf2::definition::comm> ref) const {
+    return lookup(comms_, ref.get());
+}
+
+types::communicator *DefinitionRegistry::interComm(otf2::reference<otf2::definition::inter_comm> ref) const {
+    return lookup(interComms_, ref.get());
+}
+
+std::vector<bool> DefinitionRegistry::regionMask(SlotKind kinds) const {
+    std::vector<bool> mask(regionAttributes_.size());
+    for (std::size_t region = 0; region < regionAttributes_.size(); ++region) {
+        mask[region] = (regionAttributes_[region].kind & kinds) != 0;
+    }
+    return mask;
+}
+
+std::size_t DefinitionRegistry::paletteSize() const {
+    return palette_.size();
+}
+
+const std::vector<DefinitionRegistry::PaletteEntry> &DefinitionRegistry::palette() const {
+    return palette_;
+}
+
+void DefinitionRegistry::resolveColor(std::uint32_t regionIndex) {
+    auto &entry = palette_[regionAttributes(regionIndex).paletteIndex];
+    entry.color = Slot::colorOf(lookup(regions_, regionIndex)).rgba();
+    entry.used = true;
+}
+
+void DefinitionRegistry::resolveColors() {
+    for (auto &entry: palette_) {
+        if (entry.used) {
+            entry.color = Slot::colorOf(lookup(regions_, entry.region)).rgba();
+        }
+    }
+}
+
+void DefinitionRegistry::setPaletteColor(std::uint32_t paletteIndex, const QColor &color) {
+    palette_.at(paletteIndex).color = color.rgba();
+}
+
+std::optional<std::uint32_t> DefinitionRegistry::paletteIndexOf(const std::string &name) const {
+    auto it = paletteIndices_.find(name);
+    if (it == paletteIndices_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::vector<otf2::definition::location_group *> DefinitionRegistry::locationGroups() const {
+    return all(locationGroups_);
+}
+
+std::vector<otf2::definition::location *> DefinitionRegistry::locations() const {
+    return all(locations_);
+}
+
+std::vector<otf2::definition::region *> DefinitionRegistry::regions() const {
+    return all(regions_);
+}
@@ -0,0 +1,298 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_DEFINITIONREGISTRY_HPP
+#define MOTIV_DEFINITIONREGISTRY_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <otf2xx/otf2.hpp>
+#include <QColor>
+#include <QString>
+
+#include "Slot.hpp"
+#include "src/types.hpp"
+
+/**
+ * @brief Interned definitions of a trace
+ *
+ * Every definition is stored exactly once and indexed by its OTF2 reference. Models like slots and communication
+ * events point into the registry instead of holding their own copies of the definitions. The pointers handed out stay
+ * valid for the lifetime of the registry.
+ *
+ * Attributes derived from the name of a region, like the kind of its slots, are computed once when the region is added,
+ * see RegionAttributes. Slots only store the index of their region and look the attributes up by it.
+ *
+ * Colors are not stored per region but per palette index, see PaletteEntry. Views look the color of a slot up when
+ * painting, so recoloring a region changes a single entry and only requires a repaint.
+ *
+ * The registry is filled while the definitions are read and only read afterwards, once it is filled it can be shared
+ * between threads. The palette is the exception: it is only changed on the GUI thread, loaders and other workers must
+ * not resolve colors. It is only read when painting, which the GUI thread either does itself or waits for, see
+ * RowRasterizer::forEachParallel().
+ */
+class DefinitionRegistry {
+public:
+    /**
+     * @brief Attributes of a region needed to render its slots
+     */
+    struct RegionAttributes {
+        SlotKind kind = None; /**< Kind of the slots of the region */
+        int priority = 0; /**< Z-value of the slots of the region, see Slot::priorityOf() */
+        std::uint32_t paletteIndex = 0; /**< Index of the color of the region, regions with equal names share it */
+        QString name; /**< Name of the region to be displayed */
+    };
+
+    /**
+     * @brief Color of the regions sharing a palette index
+     */
+    struct PaletteEntry {
+        QRgb color = 0; /**< Color the slots of the regions are painted with */
+        std::uint32_t region = 0; /**< Index of the first region with the palette index */
+        bool used = false; /**< Whether the color was resolved for a region occurring in the trace */
+    };
+
+    /**
+     * @brief Default colors of the slot kinds, used until the color of a region is resolved
+     */
+    struct KindColors {
+        QRgb mpi = 0; /**< Color of MPI regions */
+        QRgb openMp = 0; /**< Color of OpenMP regions */
+        QRgb plain = 0; /**< Color of all other regions */
+    };
+
+    /**
+     * @brief Creates an empty registry
+     * @param kindColors The colors new palette entries start with
+     */
+    explicit DefinitionRegistry(const KindColors &kindColors);
+
+    /**
+     * @brief Adds a location group to the registry
+     * @param locationGroup The location group definition
+     */
+    void add(const otf2::definition::location_group &locationGroup);
+
+    /**
+     * @brief Adds a location to the registry
+     * @param location The location definition
+     */
+    void add(const otf2::definition::location &location);
+
+    /**
+     * @brief Adds a region to the registry
+     * @param region The region definition
+     */
+    void add(const otf2::definition::region &region);
+
+    /**
+     * @brief Adds a communicator to the registry
+     * @param comm The communicator definition
+     */
+    void add(const otf2::definition::comm &comm);
+
+    /**
+     * @brief Adds an inter communicator to the registry
+     * @param comm The inter communicator definition
+     */
+    void add(const otf2::definition::inter_comm &comm);
+
+    /**
+     * @brief Returns the interned location group with the given reference
+     *
+     * @throws std::out_of_range if no such location group was added
+     * @param ref Reference of the location group
+     * @return The interned location group
+     */
+    [[nodiscard]] otf2::definition::location_group *locationGroup(otf2::reference<otf2::definition::location_group> ref) const;
+
+    /**
+     * @brief Returns the interned location with the given reference
+     *
+     * @throws std::out_of_range if no such location was added
+     * @param ref Reference of the location
+     * @return The interned location
+     */
+    [[nodiscard]] otf2::definition::location *location(otf2::reference<otf2::definition::location> ref) const;
+
+    /**
+     * @brief Returns the interned region with the given reference
+     *
+     * @throws std::out_of_range if no such region was added
+     * @param ref Reference of the region
+     * @return The interned region
+     */
+    [[nodiscard]] otf2::definition::region *region(otf2::reference<otf2::definition::region> ref) const;
+
+    /**
+     * @brief Returns whether a region with the given index (reference) was added
+     * @param regionIndex Index of the region
+     * @return Whether the region exists
+     */
+    [[nodiscard]] bool hasRegion(std::uint32_t regionIndex) const {
+        return regionIndex < regions_.size() && regions_[regionIndex];
+    }
+
+    /**
+     * @brief Returns the attributes of the region with the given index (reference)
+     *
+     * @throws std::out_of_range if no such region was added
+     * @param regionIndex Index of the region
+     * @return The attributes of the region
+     */
+    [[nodiscard]] const RegionAttributes &regionAttributes(std::uint32_t regionIndex) const {
+        if (regionIndex >= regionAttributes_.size()) {
+            throw std::out_of_range("Reference to an undefined region!");
+        }
+        return regionAttributes_[regionIndex];
+    }
+
+    /**
+     * @brief Returns which regions have one of the given kinds
+     *
+     * Used to restrict selections to the kinds of slots shown by a filter, see UITrace::forWindow().
+     *
+     * @param kinds The kinds of the regions to include, SlotKind values combined with a bitwise or
+     * @return Whether the region is included, indexed by region index
+     */
+    [[nodiscard]] std::vector<bool> regionMask(SlotKind kinds) const;
+
+    /**
+     * @brief Returns the number of distinct palette indices of the regions
+     * @return One more than the largest palette index
+     */
+    [[nodiscard]] std::size_t paletteSize() const;
+
+    /**
+     * @brief Returns the palette, indexed by the palette indices of the regions
+     * @return All palette entries
+     */
+    [[nodiscard]] const std::vector<PaletteEntry> &palette() const;
+
+    /**
+     * @brief Returns the color of a palette index
+     *
+     * Until the color is resolved, the default color of the kind of the region is returned.
+     *
+     * @param paletteIndex The palette index, see RegionAttributes::paletteIndex
+     * @return The color the slots with the palette index are painted with
+     */
+    [[nodiscard]] QRgb paletteColor(std::uint32_t paletteIndex) const {
+        return palette_[paletteIndex].color;
+    }
+
+    /**
+     * @brief Looks the color of a region occurring in the trace up in the ColorMap and marks its palette entry as used
+     *
+     * Regions without a color in the ColorMap are assigned one, see Slot::colorOf().
+     *
+     * @param regionIndex Index of the region
+     */
+    void resolveColor(std::uint32_t regionIndex);
+
+    /**
+     * @brief Looks the colors of all used palette entries up in the ColorMap again
+     */
+    void resolveColors();
+
+    /**
+     * @brief Sets the color of a palette index
+     * @param paletteIndex The palette index to change
+     * @param color The new color
+     */
+    void setPaletteColor(std::uint32_t paletteIndex, const QColor &color);
+
+    /**
+     * @brief Returns the palette index of the regions with the given name
+     * @param name Name of the regions
+     * @return The palette index, empty if no region has the name
+     */
+    [[nodiscard]] std::optional<std::uint32_t> paletteIndexOf(const std::string &name) const;
+
+    /**
+     * @brief Returns the interned communicator equal to the given communicator
+     *
+     * @throws std::out_of_range if no such communicator was added
+     * @param comm The (inter) communicator to look up
+     * @return The interned communicator
+     */
+    [[nodiscard]] types::communicator *communicator(const types::communicator &comm) const;
+
+    /**
+     * @brief Returns the interned communicator with the given reference
+     *
+     * @throws std::out_of_range if no such communicator was added
+     * @param ref Reference of the communicator
+     * @return The interned communicator
+     */
+    [[nodiscard]] types::communicator *comm(otf2::reference<otf2::definition::comm> ref) const;
+
+    /**
+     * @brief Returns the interned inter communicator with the given reference
+     *
+     * @throws std::out_of_range if no such inter communicator was added
+     * @param ref Reference of the inter communicator
+     * @return The interned inter communicator
+     */
+    [[nodiscard]] types::communicator *interComm(otf2::reference<otf2::definition::inter_comm> ref) const;
+
+    /**
+     * @brief Returns all interned location groups ordered by their reference
+     * @return All location groups
+     */
+    [[nodiscard]] std::vector<otf2::definition::location_group *> locationGroups() const;
+
+    /**
+     * @brief Returns all interned locations ordered by their reference
+     * @return All locations
+     */
+    [[nodiscard]] std::vector<otf2::definition::location *> locations() const;
+
+    /**
+     * @brief Returns all interned regions ordered by their reference
+     * @return All regions
+     */
+    [[nodiscard]] std::vector<otf2::definition::region *> regions() const;
+
+private:
+    template<typename T, typename D>
+    static void insert(std::vector<std::unique_ptr<T>> &table, std::size_t ref, const D &definition);
+
+    template<typename T>
+    static T *lookup(const std::vector<std::unique_ptr<T>> &table, std::size_t ref);
+
+    template<typename T>
+    static std::vector<T *> all(const std::vector<std::unique_ptr<T>> &table);
+
+private:
+    KindColors kindColors_;
+    std::vector<std::unique_ptr<otf2::definition::location_group>> locationGroups_;
+    std::vector<std::unique_ptr<otf2::definition::location>> locations_;
+    std::vector<std::unique_ptr<otf2::definition::region>> regions_;
+    std::vector<RegionAttributes> regionAttributes_;
+    std::unordered_map<std::string, std::uint32_t> paletteIndices_;
+    std::vector<PaletteEntry> palette_;
+    std::vector<std::unique_ptr<types::communicator>> comms_;
+    std::vector<std::unique_ptr<types::communicator>> interComms_;
+};
+
+#endif //MOTIV_DEFINITIONREGISTRY_HPP
@@ -0,0 +1,83 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_ELEMENTARENA_HPP
+#define MOTIV_ELEMENTARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Monotonic arena for elements synthesized while building a trace, e.g. summarized collective communications
+ *
+ * Elements are placed one after another in blocks of memory that grow geometrically. Single elements cannot be freed,
+ * all elements are destroyed and their memory is released at once when the arena is destroyed. This way the owner of the
+ * arena releases everything it synthesized in one shot.
+ */
+class ElementArena {
+public:
+    /**
+     * @brief Creates an empty arena
+     */
+    ElementArena() = default;
+
+    ElementArena(const ElementArena &) = delete;
+    ElementArena &operator=(const ElementArena &) = delete;
+
+    ~ElementArena() {
+        // Elements may refer to elements created before them
+        for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+            it->second(it->first);
+        }
+    }
+
+    /**
+     * @brief Creates an element in the arena
+     *
+     * @tparam T Type of the element
+     * @param args Arguments passed to the constructor of the element
+     * @return The element, valid as long as the arena exists
+     */
+    template<class T, class... Args>
+    T *create(Args &&... args) {
+        auto element = new(memory_.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        bytes_ += sizeof(T);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            destructors_.emplace_back(element, [](void *p) { static_cast<T *>(p)->~T(); });
+        }
+        return element;
+    }
+
+    /**
+     * @brief Returns the memory used by the elements and their bookkeeping in bytes
+     *
+     * Unused space at the end of the blocks is not included.
+     */
+    [[nodiscard]] std::size_t bytes() const {
+        return bytes_ + destructors_.capacity() * sizeof(destructors_[0]);
+    }
+
+private:
+    std::pmr::monotonic_buffer_resource memory_;
+    std::vector<std::pair<void *, void (*)(void *)>> destructors_;
+    std::size_t bytes_ = 0;
+};
+
+#endif //MOTIV_ELEMENTARENA_HPP
@@ -17,45 +17,65 @@
  */
 #include "Filetrace.hpp"
 #include "Range.hpp"
-#include "src/utils.hpp"
 
-FileTrace::FileTrace(std::vector<Slot *> &slotss,
+#include <utility>
+
+FileTrace::FileTrace(std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &slots,
                      std::vector<Communication *> &communications,
                      std::vector<CollectiveCommunicationEvent *> &collectiveCommunications,
-                     otf2::chrono::duration runtime) :
-    slotsVec_(slotss),
+                     otf2::chrono::duration runtime,
+                     std::vector<std::uint32_t> regions,
+                     std::shared_ptr<DefinitionRegistry> registry) :
     communications_(communications),
-    collectiveCommunications_(collectiveCommunications) {
+    collectiveCommunications_(collectiveCommunications),
+    registry_(std::move(registry)),
+    regions_(std::move(regions)) {
     runtime_ = runtime;
     startTime_ = otf2::chrono::duration(0);
+    slots_ = std::move(slots);
+    buildIndices();
 
-    slots_ = groupBy<Slot *, otf2::definition::location_group *, LocationGroupCmp>(
-        Range(slotsVec_),
-        [](const Slot *s) {
-            return new otf2::definition::location_group(s->location->location_group());
-        },
-        [](const Slot *l, const Slot *r) {
-            auto groupL = l->location->location_group();
-            auto groupR = r->location->location_group();
+    for (const auto &[locationGroup, store]: slots_) {
+        pyramids_.try_emplace(locationGroup);
+    }
+    systemTree_ = SystemTree(slots_, runtime_);
+}
 
-            if (groupL.ref() == groupR.ref()) {
-                return l->startTime < r->startTime;
-            }
+const SlotPyramid *FileTrace::getPyramid(otf2::definition::location_group *locationGroup) const {
+    auto it = pyramids_.find(locationGroup);
+    if (it == pyramids_.end()) {
+        return nullptr;
+    }
 
-            return groupL.ref() < groupR.ref();
-        });
+    const auto &lazy = it->second;
+    std::call_once(lazy.built, [&] {
+        lazy.pyramid.emplace(slots_.at(locationGroup), runtime_);
+    });
+    return &*lazy.pyramid;
 }
 
-std::map<otf2::definition::location_group *, Range<Slot *>, LocationGroupCmp> FileTrace::getSlots() const {
+const SystemTree *FileTrace::getSystemTree() const {
+    return &systemTree_;
+}
+
+DefinitionRegistry *FileTrace::getDefinitions() const {
+    return registry_.get();
+}
+
+const std::vector<std::uint32_t> &FileTrace::getRegions() const {
+    return regions_;
+}
+
+const std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &FileTrace::getSlots() const {
     return slots_;
 }
 
 Range<Communication *> FileTrace::getCommunications() {
-    return Range(communications_);
+    return Range<Communication *>(communications_.begin(), communications_.end());
 }
 
 Range<CollectiveCommunicationEvent *> FileTrace::getCollectiveCommunications() {
-    return Range(collectiveCommunications_);
+    return Range<CollectiveCommunicationEvent *>(collectiveCommunications_.begin(), collectiveCommunications_.end());
 }
 
 FileTrace::~FileTrace() {
@@ -66,12 +86,4 @@ FileTrace::~FileTrace() {
     for (const auto &communication: this->communications_) {
         delete communication;
     }
-
-    for (const auto &locationGroupSlotPair: this->slots_) {
-        delete locationGroupSlotPair.first;
-
-        for (const auto &slot: locationGroupSlotPair.second) {
-            delete slot;
-        }
-    }
 }
@@ -18,7 +18,13 @@
 #ifndef MOTIV_FILETRACE_HPP
 #define MOTIV_FILETRACE_HPP
 
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "DefinitionRegistry.hpp"
 #include "SubTrace.hpp"
+#include "SystemTree.hpp"
 #include "Range.hpp"
 
 /**
@@ -26,29 +32,51 @@
  */
 class FileTrace : public SubTrace {
 private:
-    std::vector<Slot *> slotsVec_;
+    /**
+     * Pyramid of a location group, built on the first request for it
+     */
+    struct LazyPyramid {
+        mutable std::once_flag built;
+        mutable std::optional<SlotPyramid> pyramid;
+    };
+
     std::vector<Communication*> communications_;
     std::vector<CollectiveCommunicationEvent*> collectiveCommunications_;
+    std::shared_ptr<DefinitionRegistry> registry_;
+    std::vector<std::uint32_t> regions_;
+    std::map<otf2::definition::location_group*, LazyPyramid, LocationGroupCmp> pyramids_;
+    SystemTree systemTree_;
 public:
+    using SubTrace::getCommunications;
+    using SubTrace::getCollectiveCommunications;
+
     /**
      * Creates a new instance
      *
-     * @param slotss vector of all slots from the trace file
+     * @param slots slots from the trace file grouped by location group and sorted by start time
      * @param communications vector of communications from the trace file
      * @param collectiveCommunications vector of collective communications from the trace file
      * @param runtime total runtime of the trace
+     * @param regions indices of all regions occurring in the slots
+     * @param registry definitions of the trace, slots and communications point into it. Previews of a trace being
+     * loaded share the registry with the loaded trace.
+     *
+     * The level of detail pyramid of a location group and the aggregates of the system tree are built on first use,
+     * so opening a trace does not visit its slots, e.g. ones mapped from the cache of the trace.
      */
-    FileTrace(std::vector<Slot*> &slotss,
+    FileTrace(std::map<otf2::definition::location_group*, SlotStore, LocationGroupCmp> &slots,
               std::vector<Communication*> &communications,
               std::vector<CollectiveCommunicationEvent*> &collectiveCommunications,
-              otf2::chrono::duration runtime);
+              otf2::chrono::duration runtime,
+              std::vector<std::uint32_t> regions,
+              std::shared_ptr<DefinitionRegistry> registry);
 
     virtual ~FileTrace();
 
     /**
      * @copydoc Trace::getSlots()
      */
-    [[nodiscard]] std::map<otf2::definition::location_group*, Range<Slot*>, LocationGroupCmp> getSlots() const override;
+    [[nodiscard]] const std::map<otf2::definition::location_group*, SlotStore, LocationGroupCmp> &getSlots() const override;
 
     /**
      * @copydoc Trace::getCommunications()
@@ -60,6 +88,28 @@ public:
      */
     [[nodiscard]] Range<CollectiveCommunicationEvent*> getCollectiveCommunications() override;
 
+    /**
+     * @copydoc Trace::getPyramid()
+     *
+     * May be called from several threads, the pyramid is built by the first caller.
+     */
+    [[nodiscard]] const SlotPyramid *getPyramid(otf2::definition::location_group *locationGroup) const override;
+
+    /**
+     * @copydoc Trace::getSystemTree()
+     */
+    [[nodiscard]] const SystemTree *getSystemTree() const override;
+
+    /**
+     * @copydoc Trace::getDefinitions()
+     */
+    [[nodiscard]] DefinitionRegistry *getDefinitions() const override;
+
+    /**
+     * Returns the indices of all regions occurring in the slots, the regions whose colors have to be resolved, see
+     * DefinitionRegistry::resolveColor()
+     */
+    [[nodiscard]] const std::vector<std::uint32_t> &getRegions() const;
 };
 
 #endif //MOTIV_FILETRACE_HPP
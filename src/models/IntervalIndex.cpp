@@ -0,0 +1,44 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "IntervalIndex.hpp"
+
+IntervalIndex::IntervalIndex(std::span<const types::TraceTime> starts, std::span<const types::TraceTime> ends) {
+    if (starts.empty() || !std::is_sorted(starts.begin(), starts.end())) {
+        return;
+    }
+
+    auto blocks = (starts.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    leaves_ = std::bit_ceil(blocks);
+    maxEnd_.assign(2 * leaves_, types::TraceTime::min());
+
+    for (std::size_t i = 0; i < ends.size(); ++i) {
+        auto &leaf = maxEnd_[leaves_ + i / BLOCK_SIZE];
+        leaf = std::max(leaf, ends[i]);
+    }
+    for (auto node = leaves_ - 1; node > 0; --node) {
+        maxEnd_[node] = std::max(maxEnd_[2 * node], maxEnd_[2 * node + 1]);
+    }
+
+    size_ = starts.size();
+}
+
+void IntervalIndex::clear() {
+    maxEnd_.clear();
+    leaves_ = 0;
+    size_ = 0;
+}
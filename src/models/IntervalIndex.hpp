@@ -0,0 +1,136 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_INTERVALINDEX_HPP
+#define MOTIV_INTERVALINDEX_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "src/types.hpp"
+
+/**
+ * @brief Index for querying the intervals overlapping a time window
+ *
+ * The index is built over intervals sorted by their start time. It is an implicit segment tree storing the maximum end
+ * time of blocks of consecutive intervals. The intervals starting before the end of a window are found by binary
+ * search. Among those, only blocks ending after the start of the window are visited, so a query costs
+ * O(log n + k) for k overlapping intervals.
+ *
+ * The index does not store the intervals themselves, the start and end times are passed to every query. Intervals that
+ * are not sorted by their start time can not be indexed, queries fall back to a linear scan then.
+ */
+class IntervalIndex {
+public:
+    /**
+     * @brief Number of consecutive intervals summarized by a leaf of the tree
+     */
+    static constexpr std::size_t BLOCK_SIZE = 64;
+
+    /**
+     * @brief Creates an empty index, queries scan linearly
+     */
+    IntervalIndex() = default;
+
+    /**
+     * @brief Creates an index of intervals
+     *
+     * @param starts Start times of the intervals
+     * @param ends End times of the intervals
+     */
+    IntervalIndex(std::span<const types::TraceTime> starts, std::span<const types::TraceTime> ends);
+
+    /**
+     * @brief Discards the index, e.g. because the intervals were modified
+     */
+    void clear();
+
+    /**
+     * @brief Returns the memory used by the index in bytes
+     */
+    [[nodiscard]] std::size_t bytes() const { return maxEnd_.capacity() * sizeof(types::TraceTime); }
+
+    /**
+     * @brief Calls a function for every interval overlapping a time window
+     *
+     * Intervals overlap the window if they start before @p to and end after @p from. The function is called with the
+     * indices of the overlapping intervals in ascending order.
+     *
+     * @param starts Start times of the intervals, the same the index was created with
+     * @param ends End times of the intervals, the same the index was created with
+     * @param from Start of the window
+     * @param to End of the window
+     * @param fn Function called with the index of every overlapping interval
+     */
+    template<typename F>
+    void forEachOverlapping(std::span<const types::TraceTime> starts, std::span<const types::TraceTime> ends,
+                            types::TraceTime from, types::TraceTime to, F fn) const {
+        if (size_ != starts.size() || starts.empty()) {
+            for (std::size_t i = 0; i < starts.size(); ++i) {
+                if (starts[i] < to && ends[i] > from) {
+                    fn(i);
+                }
+            }
+            return;
+        }
+
+        // Only intervals starting before the end of the window are candidates
+        auto candidates = static_cast<std::size_t>(std::lower_bound(starts.begin(), starts.end(), to) - starts.begin());
+        auto candidateBlocks = (candidates + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        // Depth first, left to right traversal of the tree. Every level pushes at most two nodes.
+        std::array<std::size_t, 2 * 64> stack{};
+        std::size_t top = 0;
+        stack[top++] = 1;
+        while (top > 0) {
+            auto node = stack[--top];
+            auto level = std::bit_width(node) - 1;
+            auto width = leaves_ >> level;
+            auto firstBlock = (node - (std::size_t(1) << level)) * width;
+            if (firstBlock >= candidateBlocks || maxEnd_[node] <= from) {
+                continue;
+            }
+
+            if (node < leaves_) {
+                stack[top++] = 2 * node + 1;
+                stack[top++] = 2 * node;
+                continue;
+            }
+
+            auto last = std::min(candidates, (firstBlock + 1) * BLOCK_SIZE);
+            for (auto i = firstBlock * BLOCK_SIZE; i < last; ++i) {
+                if (ends[i] > from) {
+                    fn(i);
+                }
+            }
+        }
+    }
+
+private:
+    /**
+     * Maximum end time per node, the root is at index 1 and the children of node i are 2i and 2i + 1
+     */
+    std::vector<types::TraceTime> maxEnd_;
+    std::size_t leaves_ = 0;
+    std::size_t size_ = 0;
+};
+
+#endif //MOTIV_INTERVALINDEX_HPP
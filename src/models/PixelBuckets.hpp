@@ -0,0 +1,211 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_PIXELBUCKETS_HPP
+#define MOTIV_PIXELBUCKETS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "SlotStore.hpp"
+#include "TimedElement.hpp"
+
+/**
+ * @brief Source of the pixel bucket kernel reading the slots of a SlotStore
+ *
+ * Slots are ranked by the importance of their kind: MPI, OpenMP, all others. Kinds are taken from the attributes of the
+ * regions in the definition registry of the store.
+ */
+class SlotBucketSource {
+public:
+    /**
+     * @brief Number of kinds the kernel keeps statistics for
+     */
+    static constexpr std::size_t KINDS = 3;
+
+    /**
+     * @brief Creates a new source
+     *
+     * @param slots The slots, sorted by start time
+     */
+    explicit SlotBucketSource(const SlotStore &slots)
+        : slots_(slots), starts_(slots.starts()), ends_(slots.ends()) {}
+
+    [[nodiscard]] std::size_t size() const { return starts_.size(); }
+
+    [[nodiscard]] types::TraceTime start(std::size_t i) const { return starts_[i]; }
+
+    [[nodiscard]] types::TraceTime end(std::size_t i) const { return ends_[i]; }
+
+    /**
+     * @brief Returns the rank of the kind of a slot, lower ranks are more important
+     */
+    [[nodiscard]] std::size_t kind(std::size_t i) const {
+        switch (slots_.kind(i)) {
+            case MPI:
+                return 0;
+            case OpenMP:
+                return 1;
+            default:
+                return 2;
+        }
+    }
+
+private:
+    const SlotStore &slots_;
+    std::span<const types::TraceTime> starts_;
+    std::span<const types::TraceTime> ends_;
+};
+
+/**
+ * @brief Source of the pixel bucket kernel reading timed elements, e.g. communications, of a single kind
+ *
+ * @tparam T Type of the elements
+ */
+template<class T>
+requires std::is_base_of_v<TimedElement, T>
+class ElementBucketSource {
+public:
+    static constexpr std::size_t KINDS = 1;
+
+    /**
+     * @brief Creates a new source
+     *
+     * @param elements The elements, sorted by start time
+     */
+    explicit ElementBucketSource(std::span<T *const> elements) : elements_(elements) {}
+
+    [[nodiscard]] std::size_t size() const { return elements_.size(); }
+
+    [[nodiscard]] types::TraceTime start(std::size_t i) const { return elements_[i]->getStartTime(); }
+
+    [[nodiscard]] types::TraceTime end(std::size_t i) const { return elements_[i]->getEndTime(); }
+
+    [[nodiscard]] std::size_t kind(std::size_t) const { return 0; }
+
+    [[nodiscard]] T *operator[](std::size_t i) const { return elements_[i]; }
+
+private:
+    std::span<T *const> elements_;
+};
+
+/**
+ * @brief Kernel summarizing elements too short to be rendered in buckets of fixed width, e.g. one pixel
+ *
+ * The time is divided into buckets of equal width starting at 0. Elements at least as long as a bucket are kept,
+ * shorter elements are binned into the bucket they start in. Per kind of element, a bucket keeps the longest element,
+ * the latest end and the total duration of its elements. Elements are visited once in a single pass and nothing is
+ * allocated: as the elements are sorted by start time, only the bucket currently filled has to be kept.
+ *
+ * The source, see SlotBucketSource and ElementBucketSource, is a template parameter, so the kernel is specialized for
+ * every kind of element at compile time.
+ *
+ * @tparam Source Type of the source of the elements
+ */
+template<class Source>
+class PixelBuckets {
+public:
+    /**
+     * @brief Statistics of the elements of a bucket
+     */
+    struct Bucket {
+        std::size_t first = 0; /**< Index of the first element of the bucket */
+        std::array<std::uint32_t, Source::KINDS> count{}; /**< Number of elements per kind */
+        std::array<types::TraceTime, Source::KINDS> start{}; /**< Earliest start of the elements per kind */
+        std::array<std::size_t, Source::KINDS> longest{}; /**< Index of the longest element per kind */
+        std::array<types::TraceTime, Source::KINDS> longestDuration{}; /**< Duration of the longest element per kind */
+        std::array<types::TraceTime, Source::KINDS> end{}; /**< Latest end of the elements per kind */
+        std::array<types::TraceTime, Source::KINDS> total{}; /**< Total duration of the elements per kind */
+
+        /**
+         * @brief Returns the most important kind with elements in the bucket
+         */
+        [[nodiscard]] std::size_t dominant() const {
+            return static_cast<std::size_t>(std::find_if(count.begin(), count.end(), [](auto c) { return c > 0; }) -
+                                            count.begin());
+        }
+    };
+
+    /**
+     * @brief Summarizes the elements of a source
+     *
+     * Long elements are kept as they are visited, so a summary may be reported after long elements starting in the same
+     * bucket. If the width is not positive, all elements are kept.
+     *
+     * @param source The elements, sorted by start time
+     * @param width Width of the buckets
+     * @param keep Function called with the index of every element at least as long as a bucket
+     * @param summarize Function called with every bucket containing shorter elements
+     */
+    template<typename Keep, typename Summarize>
+    static void run(const Source &source, types::TraceTime width, Keep keep, Summarize summarize) {
+        if (width.count() <= 0) {
+            for (std::size_t i = 0; i < source.size(); ++i) {
+                keep(i);
+            }
+            return;
+        }
+
+        Bucket bucket;
+        std::optional<std::int64_t> bucketIndex;
+
+        for (std::size_t i = 0; i < source.size(); ++i) {
+            auto start = source.start(i);
+            auto duration = source.end(i) - start;
+            if (duration >= width) {
+                keep(i);
+                continue;
+            }
+
+            // Buckets are aligned to 0 on both sides of it, e.g. for events before the program start
+            auto index = start.count() / width.count();
+            if (start.count() % width.count() < 0) {
+                --index;
+            }
+            if (index != bucketIndex) {
+                if (bucketIndex) {
+                    summarize(bucket);
+                }
+                bucket = Bucket();
+                bucket.first = i;
+                bucketIndex = index;
+            }
+
+            auto kind = source.kind(i);
+            if (bucket.count[kind] == 0 || duration > bucket.longestDuration[kind]) {
+                bucket.longest[kind] = i;
+                bucket.longestDuration[kind] = duration;
+            }
+            if (bucket.count[kind] == 0) {
+                bucket.start[kind] = start;
+            }
+            bucket.end[kind] = bucket.count[kind] == 0 ? source.end(i) : std::max(bucket.end[kind], source.end(i));
+            bucket.total[kind] += duration;
+            ++bucket.count[kind];
+        }
+
+        if (bucketIndex) {
+            summarize(bucket);
+        }
+    }
+};
+
+#endif //MOTIV_PIXELBUCKETS_HPP
@@ -26,10 +26,11 @@
 #include <memory>
 
 /**
- * @brief A custom range implementation around std::vector<T>s
+ * @brief An immutable view of a sequence of elements
  *
- * An instance can be created as a copy of a vector or just with to iterators. This allows a more efficient way to pass
- * sub ranges around.
+ * A range either refers to a vector owned by someone else or shares ownership of its storage with all ranges copied
+ * from it. The storage is reference counted and never modified, so copying a range is O(1) regardless of the number of
+ * elements. Ranges are cheap to pass around by value, e.g. as the communications of a trace.
  *
  * @tparam T Type of element
  */
@@ -39,7 +40,7 @@ public:
     /**
      * @brief Shortcut for the iterator
      */
-    using It = typename std::vector<T>::iterator;
+    using It = typename std::vector<T>::const_iterator;
 
     /**
      * @brief Creates an empty range
@@ -48,65 +49,25 @@ public:
 
     /**
      * @brief Creates a Range defined by two iterators.
+     *
+     * The range does not own the elements, the vector the iterators refer to has to outlive the range.
+     *
      * @param begin Iterator pointing to the begin of the range.
      * @param end Iterator pointing to one past the last element of the range.
      */
-    Range(It begin, It end) : begin_(begin), end_(end), vec_(nullptr) {};
-
-    /**
-     * @brief Constructs a new Range object from a given Range object.
-     *
-     * @param rhs The Range object to copy from.
-     */
-    Range(const Range &rhs) {
-        if (rhs.vec_) {
-            vec_ = new std::vector<T>(*rhs.vec_);
-            begin_ = std::find(vec_->begin(), vec_->end(), *rhs.begin_);
-            end_ = std::find(vec_->begin(), vec_->end(), *rhs.end_);
-        } else {
-            begin_ = rhs.begin_;
-            end_ = rhs.end_;
-        }
-    };
+    Range(It begin, It end) : begin_(begin), end_(end) {};
 
     /**
-     * Construct a range from a vector.
+     * Construct a range owning the elements of a vector.
      *
-     * Copies the vector.
-     * @param vec
+     * The storage is shared by all copies of the range.
+     * @param vec Elements of the range
      */
-    explicit Range(std::vector<T> &vec) : vec_(new std::vector<T>(vec)), begin_(vec_->begin()), end_(vec_->end()) {};
+    explicit Range(std::vector<T> vec)
+        : storage_(std::make_shared<const std::vector<T>>(std::move(vec))), begin_(storage_->begin()),
+          end_(storage_->end()) {};
 
 public:
-    /**
-     * @brief Copy assignment constructor.
-     *
-     * If the right hand side was constructed from a vector it is copied as well and the original vector is deleted.
-     * Otherwise the ranges are copied.
-     *
-     * @param rhs Right hand side of the assignment
-     * @return The copied element
-     */
-    Range<T> &operator=(const Range<T> &rhs) {
-        if (this == &rhs) {
-            return *this;
-        }
-
-
-        if (rhs.vec_) {
-            delete vec_;
-            vec_ = new std::vector<T>(*rhs.vec_);
-            begin_ = std::find(vec_->begin(), vec_->end(), *rhs.begin_);
-            end_ = std::find(vec_->begin(), vec_->end(), *rhs.end_);
-        } else {
-            begin_ = rhs.begin_;
-            end_ = rhs.end_;
-        }
-
-        return *this;
-    };
-
-
     /**
      * Iterator to the beginning of the range
      * @return
@@ -126,14 +87,36 @@ public:
      */
     [[nodiscard]] bool empty() const { return begin_ == end_; };
 
-    virtual ~Range() {
-        delete vec_;
+    /**
+     * Number of elements in the range
+     * @return The number of elements
+     */
+    [[nodiscard]] std::size_t size() const { return static_cast<std::size_t>(end_ - begin_); };
+
+    /**
+     * Element at a position of the range
+     * @param i Position of the element
+     * @return The element
+     */
+    const T &operator[](std::size_t i) const { return begin_[static_cast<std::ptrdiff_t>(i)]; };
+
+    /**
+     * Creates a range of a part of this range sharing its storage
+     * @param from Position of the first element
+     * @param to Position one past the last element
+     * @return The part of the range
+     */
+    [[nodiscard]] Range<T> subrange(std::size_t from, std::size_t to) const {
+        Range<T> range(*this);
+        range.begin_ = begin_ + static_cast<std::ptrdiff_t>(from);
+        range.end_ = begin_ + static_cast<std::ptrdiff_t>(to);
+        return range;
     };
 
 private:
-    std::vector<T> *vec_ = nullptr;
-    It begin_;
-    It end_;
+    std::shared_ptr<const std::vector<T>> storage_;
+    It begin_{};
+    It end_{};
 };
 
 #endif //MOTIV_RANGE_HPP
@@ -26,40 +26,18 @@
 ColorMap* colorMap_ = ColorMap::getInstance();
 
 Slot::Slot(const otf2::chrono::duration &start, const otf2::chrono::duration &anEnd,
-           otf2::definition::location* location, otf2::definition::region* region) :
+           otf2::definition::location_group* locationGroup, otf2::definition::region* region) :
     startTime(start),
     endTime(anEnd),
-    location(location),
-    region(region){
-        QString function_ = QString::fromStdString(region->name().str());
-        switch(this->getKind()){
-            case ::MPI:
-                this->color = colorMap_->getColor(function_);                
-                if(!this->color.isValid()) {
-                    this->color = colors::COLOR_SLOT_MPI;
-                    colorMap_->addColor(function_, this->color);
-                }
-                this->priority = layers::Z_LAYER_SLOTS_MIN_PRIORITY + 2;
-                break;
-            case ::OpenMP:
-                this->color = colorMap_->getColor(function_); 
-                if(!this->color.isValid()) {
-                    this->color = colors::COLOR_SLOT_OPEN_MP;
-                    colorMap_->addColor(function_, this->color);
-                }               
-                this->priority = layers::Z_LAYER_SLOTS_MIN_PRIORITY + 1;
-                break;
-            case ::None:
-            case ::Plain:
-                if (!this->color.isValid ()) colorMap_->addColor(function_);
-                this->color = colorMap_->getColor(function_);
-                this->priority = layers::Z_LAYER_SLOTS_MIN_PRIORITY + 0;
-                break;
-        }
-}
+    locationGroup(locationGroup),
+    region(region) {}
 
 SlotKind Slot::getKind() const {
-    auto regionName = this->region->name().str();
+    return kindOf(this->region);
+}
+
+SlotKind Slot::kindOf(const otf2::definition::region *region) {
+    auto regionName = region->name().str();
     if (regionName.starts_with("MPI_")) {
         return MPI;
     } else if (regionName.starts_with("!$omp")) {
@@ -69,6 +47,46 @@ SlotKind Slot::getKind() const {
     }
 }
 
+QColor Slot::colorOf(const otf2::definition::region *region) {
+    QString function_ = QString::fromStdString(region->name().str());
+    QColor color;
+    switch(kindOf(region)){
+        case ::MPI:
+            color = colorMap_->getColor(function_);
+            if(!color.isValid()) {
+                color = colors::COLOR_SLOT_MPI;
+                colorMap_->addColor(function_, color);
+            }
+            break;
+        case ::OpenMP:
+            color = colorMap_->getColor(function_);
+            if(!color.isValid()) {
+                color = colors::COLOR_SLOT_OPEN_MP;
+                colorMap_->addColor(function_, color);
+            }
+            break;
+        case ::None:
+        case ::Plain:
+            colorMap_->addColor(function_);
+            color = colorMap_->getColor(function_);
+            break;
+    }
+    return color;
+}
+
+int Slot::priorityOf(SlotKind kind) {
+    switch(kind){
+        case ::MPI:
+            return layers::Z_LAYER_SLOTS_MIN_PRIORITY + 2;
+        case ::OpenMP:
+            return layers::Z_LAYER_SLOTS_MIN_PRIORITY + 1;
+        case ::None:
+        case ::Plain:
+        default:
+            return layers::Z_LAYER_SLOTS_MIN_PRIORITY + 0;
+    }
+}
+
 
 types::TraceTime Slot::getStartTime() const {
     return startTime;
@@ -78,32 +96,10 @@ types::TraceTime Slot::getEndTime() const {
     return endTime;
 }
 
-
-void Slot::setColor(QColor color_){
-    QString function_ = QString::fromStdString(region->name().str());    
-    if(!color_.isValid()){
-        if(colorMap_->getColor(function_).isValid()){
-             this->color=colorMap_->getColor(function_);
-             return;
-        }
-        switch(this->getKind()){
-            case ::MPI:                
-                this->color = colors::COLOR_SLOT_MPI;
-                colorMap_->setColor(function_, this->color);                             
-                break;
-            case ::OpenMP:
-                this->color = colors::COLOR_SLOT_OPEN_MP;
-                colorMap_->setColor(function_, this->color);               
-                break;
-            case ::None:
-            case ::Plain:                
-                this->color = ColorGenerator::getInstance()->GetNewColor();
-                colorMap_->setColor(function_,this->color);
-                break;
-        } 
-    } else this->color = color_;
+QColor Slot::getColor() const {
+    return colorOf(this->region);
 }
 
-QColor Slot::getColor(){
-    return this->color;
+int Slot::getPriority() const {
+    return priorityOf(this->getKind());
 }
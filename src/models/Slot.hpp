@@ -36,6 +36,9 @@ enum SlotKind {
 /**
  * @brief A Slot represents a visual slot to be rendered in the UI. It contains the information of a
  * location.
+ *
+ * Slots of a trace are stored column wise in a SlotStore. Instances of this class are only materialized from a store
+ * when a single slot has to be handed around, e.g. when it is selected in the UI.
  */
 class Slot : public TimedElement {
 public:   
@@ -46,11 +49,11 @@ public:
      *
      * @param start @copybrief startTime
      * @param end @copybrief endTime
-     * @param location @copybrief location
+     * @param locationGroup @copybrief locationGroup
      * @param region @copybrief region
      */
     Slot(const otf2::chrono::duration &start, const otf2::chrono::duration &end,
-         otf2::definition::location *location, otf2::definition::region *region);
+         otf2::definition::location_group *locationGroup, otf2::definition::region *region);
 
     /**
      * @brief Start time of the slot relative to the trace start time
@@ -63,18 +66,18 @@ public:
     types::TraceTime endTime;
 
     /**
-     * @brief Location of the slot (thread) containing the location group (MPI rank)
+     * @brief Location group (MPI rank) the slot occurred on
+     *
+     * Points into the DefinitionRegistry of the trace.
      */
-    otf2::definition::location *location;
+    otf2::definition::location_group *locationGroup;
 
     /**
      * @brief Region the slot occurred in. For example, the source file and line.
+     *
+     * Points into the DefinitionRegistry of the trace.
      */
     otf2::definition::region *region;
-    
-    int priority;
-
-    
 
     /**
      *
@@ -94,22 +97,54 @@ public:
      * @copydoc TimedElement::getStartTime()
      */
     [[nodiscard]] types::TraceTime getEndTime() const override;
-   
-    void setColor(QColor);
-    QColor getColor();
+
+    /**
+     * @brief Returns the color of the slot in the interface
+     * @return The color of the region of the slot
+     */
+    [[nodiscard]] QColor getColor() const;
+
+    /**
+     * @brief Returns the z-value of the slot in the interface
+     * @return The z-value of the slot
+     */
+    [[nodiscard]] int getPriority() const;
+
+    /**
+     * @brief Returns the kind of slots occurring in a region
+     *
+     * The kind is determined by the name of the region.
+     *
+     * @param region The region
+     * @return The kind of slots in the region
+     */
+    [[nodiscard]] static SlotKind kindOf(const otf2::definition::region *region);
+
+    /**
+     * @brief Returns the color of slots occurring in a region
+     *
+     * The color is looked up in the ColorMap. If the region has no color yet, the default color for its kind is
+     * added to the ColorMap.
+     *
+     * @param region The region
+     * @return The color of slots in the region
+     */
+    static QColor colorOf(const otf2::definition::region *region);
+
+    /**
+     * @brief Returns the z-value of slots of a kind. More important kinds are drawn on top.
+     *
+     * @param kind The kind of slots
+     * @return The z-value of slots of the kind
+     */
+    [[nodiscard]] static int priorityOf(SlotKind kind);
 
     BUILDER(Slot,
             BUILDER_FIELD(otf2::chrono::duration, start)
                 BUILDER_FIELD(otf2::chrono::duration, end)
-                BUILDER_FIELD(otf2::definition::location * , location)
+                BUILDER_FIELD(otf2::definition::location_group * , locationGroup)
                 BUILDER_FIELD(otf2::definition::region * , region),
-            start, end, location, region)
-
-private:
-    /**
-     * @brief Color of the slot in the interface.
-     */
-    QColor color;    
+            start, end, locationGroup, region)
 };
 
 #endif //MOTIV_SLOT_HPP
@@ -0,0 +1,89 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SlotPyramid.hpp"
+#include "PixelBuckets.hpp"
+
+#include <bit>
+
+SlotPyramid::SlotPyramid(const SlotStore &slots, types::TraceTime runtime) {
+    if (slots.empty() || runtime.count() <= 0) {
+        return;
+    }
+
+    // The coarsest level has a single bucket covering the entire runtime
+    auto coarsest = static_cast<std::size_t>(std::bit_width(static_cast<std::uint64_t>(runtime.count())));
+    auto finest = coarsest > LEVELS ? coarsest - LEVELS : 0;
+
+    // Each level is summarized from the previous one, stored or not
+    levels_.reserve(coarsest - finest + 1);
+    SlotStore skipped;
+    const SlotStore *previous = &slots;
+    for (auto level = finest; level <= coarsest; ++level) {
+        auto bucketWidth = types::TraceTime(std::int64_t(1) << level);
+        auto current = summarize(*previous, bucketWidth);
+
+        // A level is only worth storing if it is at most half as large as the finer one used otherwise. This also bounds
+        // the size of all levels together by the size of the slots.
+        auto finer = levels_.empty() ? slots.size() : levels_.back().slots.size();
+        if (current.size() * 2 <= finer) {
+            levels_.push_back({bucketWidth, std::move(current)});
+            previous = &levels_.back().slots;
+        } else {
+            skipped = std::move(current);
+            previous = &skipped;
+        }
+    }
+}
+
+const SlotPyramid::Level *SlotPyramid::level(types::TraceTime maxBucketWidth) const {
+    const Level *match = nullptr;
+    for (const auto &level: levels_) {
+        if (level.bucketWidth > maxBucketWidth) {
+            break;
+        }
+        match = &level;
+    }
+    return match;
+}
+
+const std::vector<SlotPyramid::Level> &SlotPyramid::levels() const {
+    return levels_;
+}
+
+SlotStore SlotPyramid::summarize(const SlotStore &slots, types::TraceTime bucketWidth) {
+    SlotStore summary(slots.definitions());
+
+    // Every kind in a bucket is represented by its longest slot, the dominant kind is only chosen when rendering
+    using Buckets = PixelBuckets<SlotBucketSource>;
+    Buckets::run(SlotBucketSource(slots), bucketWidth,
+                 [&](std::size_t i) { summary.append(slots, i); },
+                 [&](const Buckets::Bucket &bucket) {
+                     for (std::size_t kind = 0; kind < SlotBucketSource::KINDS; ++kind) {
+                         if (bucket.count[kind] == 0) {
+                             continue;
+                         }
+                         auto longest = bucket.longest[kind];
+                         summary.push_back(bucket.start[kind], bucket.end[kind], slots.regionIndex(longest),
+                                           slots.depth(longest));
+                     }
+                 });
+
+    // Long slots starting within a bucket were added before the summaries of the bucket
+    summary.sortByStart();
+    return summary;
+}
@@ -0,0 +1,92 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_SLOTPYRAMID_HPP
+#define MOTIV_SLOTPYRAMID_HPP
+
+#include <vector>
+
+#include "SlotStore.hpp"
+
+/**
+ * @brief Level of detail pyramid of the slots of one location group (MPI rank)
+ *
+ * Every level divides the time into buckets of equal width, the width doubles from one level to the next. Slots
+ * shorter than the buckets of a level are summarized per bucket and kind (MPI, OpenMP, all others): the longest slot of
+ * the kind in the bucket, stretched from the first start to the latest end of the slots of this kind. Longer slots are
+ * kept as they are.
+ *
+ * Keeping a summary per kind instead of only the one of the most important kind lets filtered views skip the summaries
+ * of hidden kinds and still find the dominant visible slot of a bucket, see UITrace::forWindow().
+ *
+ * The pyramid is built once, each level from the previous one. When rendering a time window, the level with buckets
+ * about the duration of a pixel is used instead of the slots, so only about one slot per pixel has to be processed no
+ * matter how many slots the window contains.
+ */
+class SlotPyramid {
+public:
+    /**
+     * @brief Number of levels below the level with a single bucket for the entire runtime
+     */
+    static constexpr std::size_t LEVELS = 24;
+
+    /**
+     * @brief A level of the pyramid
+     */
+    struct Level {
+        types::TraceTime bucketWidth; /**< Width of the buckets of the level */
+        SlotStore slots; /**< Long and summarized slots, sorted by start time */
+    };
+
+    /**
+     * @brief Creates an empty pyramid
+     */
+    SlotPyramid() = default;
+
+    /**
+     * @brief Builds the pyramid of a store
+     *
+     * Levels with more than half the slots of the next finer level are omitted, so the pyramid takes at most as much
+     * memory as the slots.
+     *
+     * @param slots Slots sorted by start time
+     * @param runtime Runtime of the trace
+     */
+    SlotPyramid(const SlotStore &slots, types::TraceTime runtime);
+
+    /**
+     * @brief Returns the coarsest level with buckets not wider than the given duration
+     *
+     * @param maxBucketWidth Maximum width of the buckets, usually the duration of a pixel
+     * @return The level, nullptr if even the finest level is too coarse and the slots should be used directly
+     */
+    [[nodiscard]] const Level *level(types::TraceTime maxBucketWidth) const;
+
+    /**
+     * @brief Returns all levels from fine to coarse
+     * @return The levels of the pyramid
+     */
+    [[nodiscard]] const std::vector<Level> &levels() const;
+
+private:
+    static SlotStore summarize(const SlotStore &slots, types::TraceTime bucketWidth);
+
+private:
+    std::vector<Level> levels_;
+};
+
+#endif //MOTIV_SLOTPYRAMID_HPP
@@ -0,0 +1,113 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SlotStore.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+SlotStore::SlotStore(const DefinitionRegistry *definitions) : definitions_(definitions) {}
+
+SlotStore::SlotStore(const DefinitionRegistry *definitions, std::size_t size, const types::TraceTime *starts,
+                     const types::TraceTime *ends, const std::uint32_t *regionIndices, const std::uint32_t *depths,
+                     const std::shared_ptr<const void> &owner) :
+    definitions_(definitions),
+    start_(starts, size, owner),
+    end_(ends, size, owner),
+    regionIdx_(regionIndices, size, owner),
+    depth_(depths, size, owner) {
+    buildIndex();
+}
+
+void SlotStore::reserve(std::size_t n) {
+    start_.reserve(n);
+    end_.reserve(n);
+    regionIdx_.reserve(n);
+    depth_.reserve(n);
+}
+
+void SlotStore::push_back(types::TraceTime start, types::TraceTime end, std::uint32_t regionIndex,
+                          std::uint32_t depth) {
+    start_.push_back(start);
+    end_.push_back(end);
+    regionIdx_.push_back(regionIndex);
+    depth_.push_back(depth);
+    index_.clear();
+}
+
+void SlotStore::append(const SlotStore &other, std::size_t i) {
+    push_back(other.start_[i], other.end_[i], other.regionIdx_[i], other.depth_[i]);
+}
+
+void SlotStore::shift(types::TraceTime delta) {
+    auto add = [delta](std::vector<types::TraceTime> &times) {
+        for (auto &time: times) {
+            time += delta;
+        }
+    };
+    start_.modify(add);
+    end_.modify(add);
+    index_.clear();
+}
+
+template<typename T>
+static void permute(SlotColumn<T> &column, const std::vector<std::size_t> &order) {
+    column.modify([&order](std::vector<T> &values) {
+        std::vector<T> permuted;
+        permuted.reserve(values.size());
+        for (const auto &i: order) {
+            permuted.push_back(values[i]);
+        }
+        values = std::move(permuted);
+    });
+}
+
+void SlotStore::sortByStart() {
+    auto starts = start_.view();
+    if (std::is_sorted(starts.begin(), starts.end())) {
+        buildIndex();
+        return;
+    }
+
+    std::vector<std::size_t> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&starts](std::size_t lhs, std::size_t rhs) {
+        return starts[lhs] < starts[rhs];
+    });
+
+    permute(start_, order);
+    permute(end_, order);
+    permute(regionIdx_, order);
+    permute(depth_, order);
+    buildIndex();
+}
+
+void SlotStore::buildIndex() {
+    index_ = IntervalIndex(starts(), ends());
+}
+
+otf2::definition::region *SlotStore::region(std::size_t i) const {
+    return definitions_->region(otf2::reference<otf2::definition::region>(regionIdx_[i]));
+}
+
+SlotKind SlotStore::kind(std::size_t i) const {
+    return definitions_->regionAttributes(regionIdx_[i]).kind;
+}
+
+Slot SlotStore::slot(std::size_t i, otf2::definition::location_group *locationGroup) const {
+    return {start_[i], end_[i], locationGroup, region(i)};
+}
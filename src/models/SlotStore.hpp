@@ -0,0 +1,338 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_SLOTSTORE_HPP
+#define MOTIV_SLOTSTORE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "DefinitionRegistry.hpp"
+#include "IntervalIndex.hpp"
+#include "Slot.hpp"
+
+/**
+ * @brief A single column of a SlotStore
+ *
+ * A column either owns its values or refers to values owned by someone else, e.g. a memory mapped cache file. The
+ * values of a foreign column are copied as soon as the column is modified.
+ *
+ * @tparam T Type of the values
+ */
+template<typename T>
+class SlotColumn {
+public:
+    SlotColumn() = default;
+
+    /**
+     * @brief Creates a column referring to foreign values
+     *
+     * @param data The values
+     * @param size Number of values
+     * @param owner Keeps the values alive as long as the column refers to them
+     */
+    SlotColumn(const T *data, std::size_t size, std::shared_ptr<const void> owner) :
+        data_(data), size_(size), owner_(std::move(owner)) {}
+
+    SlotColumn(const SlotColumn &rhs) : values_(rhs.values_), data_(rhs.data_), size_(rhs.size_), owner_(rhs.owner_) {
+        if (!owner_) sync();
+    }
+
+    SlotColumn(SlotColumn &&rhs) noexcept :
+        values_(std::move(rhs.values_)), data_(rhs.data_), size_(rhs.size_), owner_(std::move(rhs.owner_)) {
+        if (!owner_) sync();
+        rhs.sync();
+    }
+
+    SlotColumn &operator=(const SlotColumn &rhs) {
+        if (this != &rhs) {
+            values_ = rhs.values_;
+            data_ = rhs.data_;
+            size_ = rhs.size_;
+            owner_ = rhs.owner_;
+            if (!owner_) sync();
+        }
+        return *this;
+    }
+
+    SlotColumn &operator=(SlotColumn &&rhs) noexcept {
+        if (this != &rhs) {
+            values_ = std::move(rhs.values_);
+            data_ = rhs.data_;
+            size_ = rhs.size_;
+            owner_ = std::move(rhs.owner_);
+            if (!owner_) sync();
+            rhs.sync();
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Returns all values of the column
+     * @return The values
+     */
+    [[nodiscard]] std::span<const T> view() const { return {data_, size_}; }
+
+    [[nodiscard]] const T &operator[](std::size_t i) const { return data_[i]; }
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+    void reserve(std::size_t n) {
+        detach();
+        values_.reserve(n);
+        sync();
+    }
+
+    void push_back(const T &value) {
+        detach();
+        values_.push_back(value);
+        sync();
+    }
+
+    /**
+     * @brief Modifies the values of the column
+     * @param fn Function modifying the vector of values in place
+     */
+    template<typename F>
+    void modify(F fn) {
+        detach();
+        fn(values_);
+        sync();
+    }
+
+private:
+    void detach() {
+        if (owner_) {
+            values_.assign(data_, data_ + size_);
+            owner_.reset();
+        }
+    }
+
+    void sync() {
+        data_ = values_.data();
+        size_ = values_.size();
+    }
+
+private:
+    std::vector<T> values_;
+    const T *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::shared_ptr<const void> owner_;
+};
+
+/**
+ * @brief Column wise storage of the slots of one location group (MPI rank)
+ *
+ * Instead of one object per slot, the attributes of all slots are stored in contiguous columns: start and end time,
+ * the index (OTF2 reference) of the region and the depth in the call stack of the location the slot occurred on.
+ * A slot takes 24 bytes this way and scanning over the slots only touches the columns that are actually needed.
+ *
+ * Slots are sorted by their start time once the store is completely built, see sortByStart(). Sorted stores are
+ * indexed, so the slots overlapping a time window can be found without scanning all slots. Slot objects can be
+ * materialized for single slots with slot(). The columns of a store can also refer to memory owned by someone else,
+ * e.g. a memory mapped cache file.
+ */
+class SlotStore {
+public:
+    /**
+     * @brief Creates an empty store
+     *
+     * @param definitions Registry the region indices of the store refer to
+     */
+    explicit SlotStore(const DefinitionRegistry *definitions = nullptr);
+
+    /**
+     * @brief Creates a store referring to columns owned by someone else
+     *
+     * The columns are copied as soon as the store is modified.
+     *
+     * @param definitions Registry the region indices of the store refer to
+     * @param size Number of slots
+     * @param starts Start times of the slots
+     * @param ends End times of the slots
+     * @param regionIndices Region indices of the slots
+     * @param depths Call stack depths of the slots
+     * @param owner Keeps the columns alive as long as the store refers to them
+     */
+    SlotStore(const DefinitionRegistry *definitions, std::size_t size, const types::TraceTime *starts,
+              const types::TraceTime *ends, const std::uint32_t *regionIndices, const std::uint32_t *depths,
+              const std::shared_ptr<const void> &owner);
+
+    /**
+     * @brief Reserves space for a number of slots
+     * @param n Number of slots
+     */
+    void reserve(std::size_t n);
+
+    /**
+     * @brief Appends a slot to the store
+     *
+     * @param start Start time of the slot
+     * @param end End time of the slot
+     * @param regionIndex Index of the region of the slot in the definition registry
+     * @param depth Depth of the slot in the call stack
+     */
+    void push_back(types::TraceTime start, types::TraceTime end, std::uint32_t regionIndex, std::uint32_t depth);
+
+    /**
+     * @brief Appends a slot of another store to this store
+     *
+     * @param other The store containing the slot
+     * @param i Index of the slot in @p other
+     */
+    void append(const SlotStore &other, std::size_t i);
+
+    /**
+     * @brief Adds a duration to the start and end time of all slots
+     * @param delta The duration to add
+     */
+    void shift(types::TraceTime delta);
+
+    /**
+     * @brief Sorts all slots by their start time, slots starting at the same time keep their order
+     *
+     * The store is indexed afterwards.
+     */
+    void sortByStart();
+
+    /**
+     * @brief Indexes the slots of a store that is already sorted by start time
+     *
+     * Modifying the store discards the index.
+     */
+    void buildIndex();
+
+    /**
+     * @brief Calls a function for every slot overlapping a time window
+     *
+     * Slots overlap the window if they start before @p to and end after @p from. Without an index, all slots are
+     * scanned.
+     *
+     * @param from Start of the window
+     * @param to End of the window
+     * @param fn Function called with the index of every overlapping slot in ascending order
+     */
+    template<typename F>
+    void forEachOverlapping(types::TraceTime from, types::TraceTime to, F fn) const {
+        index_.forEachOverlapping(starts(), ends(), from, to, fn);
+    }
+
+    /**
+     * @brief Returns the number of slots in the store
+     * @return The number of slots
+     */
+    [[nodiscard]] std::size_t size() const { return start_.size(); }
+
+    /**
+     * @brief Whether the store contains no slots
+     * @return true if the store is empty
+     */
+    [[nodiscard]] bool empty() const { return start_.size() == 0; }
+
+    /**
+     * @brief Returns the registry the region indices of the store refer to
+     * @return The definition registry
+     */
+    [[nodiscard]] const DefinitionRegistry *definitions() const { return definitions_; }
+
+    /**
+     * @brief Returns the column of start times
+     * @return Start times of all slots
+     */
+    [[nodiscard]] std::span<const types::TraceTime> starts() const { return start_.view(); }
+
+    /**
+     * @brief Returns the column of end times
+     * @return End times of all slots
+     */
+    [[nodiscard]] std::span<const types::TraceTime> ends() const { return end_.view(); }
+
+    /**
+     * @brief Returns the column of region indices
+     * @return Region indices of all slots
+     */
+    [[nodiscard]] std::span<const std::uint32_t> regionIndices() const { return regionIdx_.view(); }
+
+    /**
+     * @brief Returns the column of call stack depths
+     * @return Call stack depths of all slots
+     */
+    [[nodiscard]] std::span<const std::uint32_t> depths() const { return depth_.view(); }
+
+    /**
+     * @brief Returns the start time of a slot
+     * @param i Index of the slot
+     * @return The start time of the slot
+     */
+    [[nodiscard]] types::TraceTime start(std::size_t i) const { return start_[i]; }
+
+    /**
+     * @brief Returns the end time of a slot
+     * @param i Index of the slot
+     * @return The end time of the slot
+     */
+    [[nodiscard]] types::TraceTime end(std::size_t i) const { return end_[i]; }
+
+    /**
+     * @brief Returns the region index of a slot
+     * @param i Index of the slot
+     * @return The index of the region of the slot in the definition registry
+     */
+    [[nodiscard]] std::uint32_t regionIndex(std::size_t i) const { return regionIdx_[i]; }
+
+    /**
+     * @brief Returns the call stack depth of a slot
+     * @param i Index of the slot
+     * @return The call stack depth of the slot
+     */
+    [[nodiscard]] std::uint32_t depth(std::size_t i) const { return depth_[i]; }
+
+    /**
+     * @brief Returns the region of a slot
+     * @param i Index of the slot
+     * @return The region of the slot
+     */
+    [[nodiscard]] otf2::definition::region *region(std::size_t i) const;
+
+    /**
+     * @brief Returns the kind of a slot
+     * @param i Index of the slot
+     * @return The kind of the slot
+     */
+    [[nodiscard]] SlotKind kind(std::size_t i) const;
+
+    /**
+     * @brief Materializes a slot of the store
+     *
+     * @param i Index of the slot
+     * @param locationGroup Location group this store belongs to
+     * @return The slot
+     */
+    [[nodiscard]] Slot slot(std::size_t i, otf2::definition::location_group *locationGroup) const;
+
+private:
+    const DefinitionRegistry *definitions_;
+    SlotColumn<types::TraceTime> start_;
+    SlotColumn<types::TraceTime> end_;
+    SlotColumn<std::uint32_t> regionIdx_;
+    SlotColumn<std::uint32_t> depth_;
+    IntervalIndex index_;
+};
+
+#endif //MOTIV_SLOTSTORE_HPP
@@ -21,7 +21,7 @@
 #include <utility>
 
 
-SubTrace::SubTrace(std::map<otf2::definition::location_group *, Range<Slot *>, LocationGroupCmp> &slots,
+SubTrace::SubTrace(std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &slots,
                    const Range<Communication *> &communications,
                    const Range<CollectiveCommunicationEvent *> &collectiveCommunications,
                    const otf2::chrono::duration &runtime,
@@ -30,7 +30,9 @@ SubTrace::SubTrace(std::map<otf2::definition::location_group *, Range<Slot *>, L
     communications_(communications),
     collectiveCommunications_(collectiveCommunications),
     runtime_(runtime),
-    startTime_(startTime) {}
+    startTime_(startTime) {
+    buildIndices();
+}
 
 SubTrace::SubTrace()
     : slots_(),
@@ -39,7 +41,7 @@ SubTrace::SubTrace()
       runtime_(),
       startTime_() {};
 
-std::map<otf2::definition::location_group *, Range<Slot *>, LocationGroupCmp> SubTrace::getSlots() const {
+const std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &SubTrace::getSlots() const {
     return slots_;
 }
 
@@ -60,50 +62,79 @@ otf2::chrono::duration SubTrace::getStartTime() const {
 }
 
 
-template<typename T>
-using TimeAccessor = std::function<otf2::chrono::duration(T const &)>;
-
-
-namespace accessors {
-    const TimeAccessor<Slot *> slotStart = &Slot::startTime;
-    const TimeAccessor<Slot *> slotEnd = &Slot::endTime;
-
-    const TimeAccessor<CommunicationEvent *> communicationEventStart = &CommunicationEvent::getStartTime;
-    const TimeAccessor<CommunicationEvent *> communicationEventEnd = &CommunicationEvent::getEndTime;
-
-    const TimeAccessor<Communication *> communicationStart = [](
-        const Communication *e) { return e->getStartEvent()->getStartTime(); };
-    const TimeAccessor<Communication *> communicationEnd = [](const Communication *e) { return e->getEndEvent()->getEndTime(); };
-};
+/**
+ * Collects the start and end times of a range of timed elements and indexes them.
+ */
+template<typename T, typename S, typename E>
+static void indexRange(Range<T> range, S getStart, E getEnd, std::vector<types::TraceTime> &starts,
+                       std::vector<types::TraceTime> &ends, IntervalIndex &index) {
+    starts.clear();
+    ends.clear();
+    for (const auto &element: range) {
+        starts.push_back(getStart(element));
+        ends.push_back(getEnd(element));
+    }
+    index = IntervalIndex(starts, ends);
+}
 
+/**
+ * Copies the elements of a range overlapping a time window.
+ */
 template<typename T>
-static Range<T> subRange(Range<T> r, otf2::chrono::duration from, otf2::chrono::duration to, TimeAccessor<T> getStart,
-                         TimeAccessor<T> getEnd) {
+static Range<T> subRange(Range<T> range, const IntervalIndex &index, const std::vector<types::TraceTime> &starts,
+                         const std::vector<types::TraceTime> &ends, otf2::chrono::duration from,
+                         otf2::chrono::duration to) {
     std::vector<T> newVec;
-    std::copy_if(r.begin(), r.end(), std::back_inserter(newVec), [from, to, getStart, getEnd](T x) {
-        return getStart(x) < to && getEnd(x) > from;
+    auto begin = range.begin();
+    index.forEachOverlapping(starts, ends, from, to, [&newVec, &begin](std::size_t i) {
+        newVec.push_back(*(begin + static_cast<std::ptrdiff_t>(i)));
     });
 
-    Range<T> newRange(newVec);
+    return Range<T>(std::move(newVec));
+}
+
+void SubTrace::buildIndices() {
+    indexRange(getCommunications(),
+               [](const Communication *e) { return e->getStartEvent()->getStartTime(); },
+               [](const Communication *e) { return e->getEndEvent()->getEndTime(); },
+               communicationStarts_, communicationEnds_, communicationIndex_);
+    indexRange(getCollectiveCommunications(),
+               [](const CollectiveCommunicationEvent *e) { return e->getStartTime(); },
+               [](const CollectiveCommunicationEvent *e) { return e->getEndTime(); },
+               collectiveCommunicationStarts_, collectiveCommunicationEnds_, collectiveCommunicationIndex_);
+}
+
+std::size_t SubTrace::indexBytes() const {
+    auto times = communicationStarts_.capacity() + communicationEnds_.capacity() +
+                 collectiveCommunicationStarts_.capacity() + collectiveCommunicationEnds_.capacity();
+    return times * sizeof(types::TraceTime) + communicationIndex_.bytes() + collectiveCommunicationIndex_.bytes();
+}
 
-    return newRange;
+Range<Communication *> SubTrace::getCommunications(otf2::chrono::duration from, otf2::chrono::duration to) {
+    return subRange(getCommunications(), communicationIndex_, communicationStarts_, communicationEnds_, from, to);
 }
 
+Range<CollectiveCommunicationEvent *>
+SubTrace::getCollectiveCommunications(otf2::chrono::duration from, otf2::chrono::duration to) {
+    return subRange(getCollectiveCommunications(), collectiveCommunicationIndex_, collectiveCommunicationStarts_,
+                    collectiveCommunicationEnds_, from, to);
+}
 
 Trace *SubTrace::subtrace(otf2::chrono::duration from, otf2::chrono::duration to) {
-    std::map<otf2::definition::location_group *, Range<Slot *>, LocationGroupCmp> newSlots;
+    std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> newSlots;
     for (const auto &item: getSlots()) {
-        Range<Slot *> slots = subRange(item.second, from, to, accessors::slotStart, accessors::slotEnd);
-        std::sort(slots.begin(), slots.end(), [](const Slot* lhs, const Slot* rhs) {return lhs->startTime < rhs->startTime;});
-        newSlots.insert({item.first, slots});
+        // Slots are sorted by their start time, the sub store keeps that order
+        const auto &slots = item.second;
+
+        SlotStore newSlotsForRank(slots.definitions());
+        slots.forEachOverlapping(from, to, [&newSlotsForRank, &slots](std::size_t i) {
+            newSlotsForRank.append(slots, i);
+        });
+        newSlotsForRank.buildIndex();
+        newSlots.insert({item.first, std::move(newSlotsForRank)});
     }
-    auto newCommunications = subRange(getCommunications(), from, to, accessors::communicationStart,
-                                      accessors::communicationEnd);
-    auto newCollectiveCommunications = subRange<CollectiveCommunicationEvent *>(getCollectiveCommunications(),
-                                                                                from,
-                                                                                to,
-                                                                                accessors::communicationEventStart,
-                                                                                accessors::communicationEventEnd);
+    auto newCommunications = getCommunications(from, to);
+    auto newCollectiveCommunications = getCollectiveCommunications(from, to);
 
     auto trace = new SubTrace(newSlots, newCommunications, newCollectiveCommunications, to - from, from);
 
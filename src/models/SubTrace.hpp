@@ -18,6 +18,7 @@
 #ifndef MOTIV_SUBTRACE_HPP
 #define MOTIV_SUBTRACE_HPP
 
+#include "IntervalIndex.hpp"
 #include "Trace.hpp"
 #include "Range.hpp"
 
@@ -30,7 +31,7 @@ public:
     /**
      * @copydoc Trace::getSlots()
      */
-    [[nodiscard]] std::map<otf2::definition::location_group*, Range<Slot*>, LocationGroupCmp> getSlots() const override;
+    [[nodiscard]] const std::map<otf2::definition::location_group*, SlotStore, LocationGroupCmp> &getSlots() const override;
 
     /**
      * @copydoc Trace::getRuntime()
@@ -54,6 +55,25 @@ public:
     [[nodiscard]] Range<CollectiveCommunicationEvent*> getCollectiveCommunications() override;
 
 
+    /**
+     * @brief Returns the communications overlapping a time window
+     *
+     * @param from Start of the window
+     * @param to End of the window
+     * @return The communications overlapping the window
+     */
+    [[nodiscard]] Range<Communication*> getCommunications(otf2::chrono::duration from, otf2::chrono::duration to);
+
+    /**
+     * @brief Returns the collective communications overlapping a time window
+     *
+     * @param from Start of the window
+     * @param to End of the window
+     * @return The collective communications overlapping the window
+     */
+    [[nodiscard]] Range<CollectiveCommunicationEvent*> getCollectiveCommunications(otf2::chrono::duration from,
+                                                                                   otf2::chrono::duration to);
+
     /**
      * @copydoc Trace::getStartTime()
      */
@@ -69,11 +89,16 @@ public:
      */
     [[nodiscard]] types::TraceTime getDuration() const override;
 
+    /**
+     * Returns the memory used by the indices of the communications and collective communications in bytes
+     */
+    [[nodiscard]] std::size_t indexBytes() const;
+
 protected:
     /**
      * Backing field for the range of slots of this subtrace
      */
-    std::map<otf2::definition::location_group*, Range<Slot*>, LocationGroupCmp> slots_;
+    std::map<otf2::definition::location_group*, SlotStore, LocationGroupCmp> slots_;
 
     /**
      * Backing field for communications of this subtrace
@@ -94,6 +119,27 @@ protected:
      * Backing field for the start time of this subtrace
      */
     otf2::chrono::duration startTime_{};
+
+    /**
+     * Indexes the communications and collective communications of this subtrace for subtrace(). Has to be called
+     * whenever the ranges of communications are set.
+     */
+    void buildIndices();
+
+private:
+    /**
+     * Start and end times of the communications, in the order of @ref communications_
+     */
+    std::vector<types::TraceTime> communicationStarts_;
+    std::vector<types::TraceTime> communicationEnds_;
+    IntervalIndex communicationIndex_;
+
+    /**
+     * Start and end times of the collective communications, in the order of @ref collectiveCommunications_
+     */
+    std::vector<types::TraceTime> collectiveCommunicationStarts_;
+    std::vector<types::TraceTime> collectiveCommunicationEnds_;
+    IntervalIndex collectiveCommunicationIndex_;
 public:
     /**
      * Initializes an empty subtrace
@@ -103,12 +149,12 @@ public:
     /**
      * Initializes a new instance.
      *
-     * @param slots Range of slots this subtrace covers
+     * @param slots Slots this subtrace covers
      * @param communications Range of communications this subtrace covers
      * @param collectiveCommunications Range of collective communication this subtrace covers
      * @param runtime Runtime of this subtrace
      */
-    SubTrace(std::map<otf2::definition::location_group*, Range<Slot*>, LocationGroupCmp> &slots,
+    SubTrace(std::map<otf2::definition::location_group*, SlotStore, LocationGroupCmp> &slots,
              const Range<Communication*> &communications,
              const Range<CollectiveCommunicationEvent*> &collectiveCommunications,
              const otf2::chrono::duration &runtime,
@@ -0,0 +1,235 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SystemTree.hpp"
+
+#include <algorithm>
+
+namespace {
+    template<typename T>
+    void addTime(std::vector<std::pair<std::uint32_t, T>> &times, std::uint32_t region, T time) {
+        auto it = std::find_if(times.begin(), times.end(), [region](const auto &entry) {
+            return entry.first == region;
+        });
+        if (it != times.end()) {
+            it->second += time;
+        } else {
+            times.emplace_back(region, time);
+        }
+    }
+
+    template<typename T>
+    const std::pair<std::uint32_t, T> *longest(const std::vector<std::pair<std::uint32_t, T>> &times) {
+        auto it = std::max_element(times.begin(), times.end(), [](const auto &l, const auto &r) {
+            return l.second < r.second;
+        });
+        return it != times.end() ? &*it : nullptr;
+    }
+}
+
+SystemTree::SystemTree(const std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &slots,
+                       types::TraceTime runtime) : slots_(&slots) {
+    std::map<std::uint64_t, std::size_t> indices;
+    for (const auto &[locationGroup, store]: slots) {
+        nodes_[addNode(locationGroup->parent(), indices)].locationGroups.push_back(locationGroup);
+    }
+
+    if (runtime.count() > 0) {
+        auto width = (runtime.count() + static_cast<std::int64_t>(BUCKETS) - 1) / static_cast<std::int64_t>(BUCKETS);
+        bucketWidth_ = types::TraceTime(width);
+        bucketCount_ = static_cast<std::size_t>((runtime.count() + width - 1) / width);
+    }
+
+    for (auto root: roots_) {
+        countRanks(root);
+    }
+}
+
+std::size_t SystemTree::addNode(const otf2::definition::system_tree_node &definition,
+                                std::map<std::uint64_t, std::size_t> &indices) {
+    auto ref = static_cast<std::uint64_t>(definition.ref().get());
+    if (auto it = indices.find(ref); it != indices.end()) {
+        return it->second;
+    }
+
+    // Ancestors are added first, so parents precede their children
+    auto parent = definition.has_parent() ? addNode(definition.parent(), indices) : NO_NODE;
+
+    Node node;
+    node.name = definition.name().str();
+    node.className = definition.class_name().str();
+    node.parent = parent;
+    node.depth = parent == NO_NODE ? 0 : nodes_[parent].depth + 1;
+
+    auto index = nodes_.size();
+    nodes_.push_back(std::move(node));
+    if (parent == NO_NODE) {
+        roots_.push_back(index);
+    } else {
+        nodes_[parent].children.push_back(index);
+    }
+    indices.emplace(ref, index);
+    return index;
+}
+
+std::size_t SystemTree::countRanks(std::size_t node) {
+    auto ranks = nodes_[node].locationGroups.size();
+    for (auto child: nodes_[node].children) {
+        ranks += countRanks(child);
+    }
+    nodes_[node].ranks = ranks;
+    return ranks;
+}
+
+void SystemTree::aggregateOnce() const {
+    // Several rows may request buckets from the thread pool at once, only the first one builds them
+    std::call_once(*aggregated_, [this] {
+        buckets_.resize(nodes_.size());
+        for (auto root: roots_) {
+            aggregate(root);
+        }
+    });
+}
+
+void SystemTree::aggregate(std::size_t node) const {
+    // Dominant regions of ranks and child nodes are weighted by their time and merged per bucket
+    std::vector<std::vector<std::pair<std::uint32_t, float>>> candidates(bucketCount_);
+    std::vector<float> mpiTimes(bucketCount_);
+    auto merge = [&](const std::vector<Bucket> &buckets) {
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            if (buckets[i].region != NO_REGION) {
+                addTime(candidates[i], buckets[i].region, buckets[i].regionTime);
+            }
+            mpiTimes[i] += buckets[i].mpiTime;
+        }
+    };
+
+    for (auto child: nodes_[node].children) {
+        aggregate(child);
+        merge(buckets_[child]);
+    }
+    for (auto locationGroup: nodes_[node].locationGroups) {
+        merge(rankBuckets(slots_->at(locationGroup)));
+    }
+
+    auto &buckets = buckets_[node];
+    buckets.resize(bucketCount_);
+    for (std::size_t i = 0; i < bucketCount_; ++i) {
+        if (auto dominant = longest(candidates[i])) {
+            buckets[i].region = dominant->first;
+            buckets[i].regionTime = dominant->second;
+        }
+        buckets[i].mpiTime = mpiTimes[i];
+    }
+}
+
+std::vector<SystemTree::Bucket> SystemTree::rankBuckets(const SlotStore &slots) const {
+    std::vector<Bucket> buckets(bucketCount_);
+    auto width = bucketWidth_.count();
+
+    // Region times of the bucket currently swept, the exclusive intervals arrive in temporal order
+    std::vector<std::pair<std::uint32_t, double>> times;
+    auto currentBucket = bucketCount_;
+    auto finishBucket = [&] {
+        if (auto dominant = longest(times)) {
+            buckets[currentBucket].region = dominant->first;
+            buckets[currentBucket].regionTime = static_cast<float>(dominant->second);
+        }
+        times.clear();
+    };
+
+    auto addExclusive = [&](std::int64_t from, std::int64_t to, std::size_t slot) {
+        if (from >= to) {
+            return;
+        }
+
+        auto region = slots.regionIndex(slot);
+        auto mpi = slots.kind(slot) == MPI;
+
+        for (auto bucket = static_cast<std::size_t>(std::max<std::int64_t>(from, 0) / width);
+             bucket < bucketCount_ && static_cast<std::int64_t>(bucket) * width < to; ++bucket) {
+            auto start = std::max(from, static_cast<std::int64_t>(bucket) * width);
+            auto end = std::min(to, static_cast<std::int64_t>(bucket + 1) * width);
+            if (bucket != currentBucket) {
+                finishBucket();
+                currentBucket = bucket;
+            }
+            addTime(times, region, static_cast<double>(end - start));
+            if (mpi) {
+                buckets[bucket].mpiTime += static_cast<float>(end - start);
+            }
+        }
+    };
+
+    // Sweep the slots keeping the stack of enclosing slots, the innermost slot owns the time
+    std::vector<std::size_t> stack;
+    std::int64_t time = 0;
+    auto starts = slots.starts();
+    auto ends = slots.ends();
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        auto start = starts[i].count();
+        while (!stack.empty() && ends[stack.back()].count() <= start) {
+            auto end = ends[stack.back()].count();
+            addExclusive(time, end, stack.back());
+            time = std::max(time, end);
+            stack.pop_back();
+        }
+        if (!stack.empty()) {
+            addExclusive(time, start, stack.back());
+        }
+        time = std::max(time, start);
+        stack.push_back(i);
+    }
+    while (!stack.empty()) {
+        auto end = ends[stack.back()].count();
+        addExclusive(time, end, stack.back());
+        time = std::max(time, end);
+        stack.pop_back();
+    }
+
+    if (currentBucket < bucketCount_) {
+        finishBucket();
+    }
+    return buckets;
+}
+
+SlotStore SystemTree::aggregatedSlots(std::size_t node, types::TraceTime from, types::TraceTime to,
+                                      const DefinitionRegistry *definitions) const {
+    SlotStore slots(definitions);
+
+    auto region = NO_REGION;
+    types::TraceTime start{0};
+    types::TraceTime end{0};
+    forEachBucket(node, from, to, [&](types::TraceTime bucketStart, types::TraceTime bucketEnd, const Bucket &bucket) {
+        if (bucket.region == region && bucketStart == end) {
+            end = bucketEnd;
+            return;
+        }
+        if (region != NO_REGION) {
+            slots.push_back(start, end, region, 0);
+        }
+        region = bucket.region;
+        start = bucketStart;
+        end = bucketEnd;
+    });
+    if (region != NO_REGION) {
+        slots.push_back(start, end, region, 0);
+    }
+
+    slots.buildIndex();
+    return slots;
+}
@@ -0,0 +1,174 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_SYSTEMTREE_HPP
+#define MOTIV_SYSTEMTREE_HPP
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SlotStore.hpp"
+#include "Trace.hpp"
+
+/**
+ * @brief Hierarchy of the location groups (MPI ranks) of a trace along the OTF2 system tree
+ *
+ * Every system tree node (machine, node, ...) holding location groups becomes a node of the tree. For every node, the
+ * time of the trace is divided into BUCKETS buckets of equal width. Each bucket stores the dominant region of the ranks
+ * below the node, the region most ranks spend their exclusive time in, and the accumulated time the ranks spend in MPI.
+ *
+ * The aggregates are built bottom-up once: the slots of every rank are swept a single time, nodes merge the buckets of
+ * their ranks and child nodes. Afterwards a collapsed node can be drawn as a single row without visiting its ranks.
+ * Only the nodes are built with the tree, the aggregates are built when buckets are first requested, so traces never
+ * showing a collapsed node never sweep their slots. The slots the tree was built from have to outlive it.
+ */
+class SystemTree {
+public:
+    /**
+     * @brief Maximum number of buckets the runtime is divided into
+     */
+    static constexpr std::size_t BUCKETS = 2048;
+
+    static constexpr std::size_t NO_NODE = std::numeric_limits<std::size_t>::max();
+
+    static constexpr std::uint32_t NO_REGION = std::numeric_limits<std::uint32_t>::max();
+
+    /**
+     * @brief Aggregate of the ranks below a node in a bucket of time
+     */
+    struct Bucket {
+        std::uint32_t region = NO_REGION; /**< Index of the dominant region, NO_REGION if no rank has a slot */
+        float regionTime = 0; /**< Exclusive time the ranks spend in the dominant region */
+        float mpiTime = 0; /**< Exclusive time the ranks spend in MPI regions */
+    };
+
+    /**
+     * @brief A node of the system tree
+     */
+    struct Node {
+        std::string name; /**< Name of the system tree node */
+        std::string className; /**< Class of the system tree node, e.g. machine or node */
+        std::size_t parent = NO_NODE; /**< Index of the parent node */
+        std::size_t depth = 0; /**< Number of ancestors */
+        std::vector<std::size_t> children; /**< Indices of the child nodes */
+        std::vector<otf2::definition::location_group *> locationGroups; /**< Location groups directly below */
+        std::size_t ranks = 0; /**< Number of location groups in the subtree */
+    };
+
+    /**
+     * @brief Creates an empty tree
+     */
+    SystemTree() = default;
+
+    /**
+     * @brief Builds the tree, the aggregates of its nodes are built on first use
+     *
+     * @param slots Slots of the trace grouped by location group and sorted by start time
+     * @param runtime Runtime of the trace
+     */
+    SystemTree(const std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &slots,
+               types::TraceTime runtime);
+
+    /**
+     * @brief Returns all nodes, parents precede their children
+     */
+    [[nodiscard]] const std::vector<Node> &nodes() const { return nodes_; }
+
+    /**
+     * @brief Returns the indices of the nodes without parent
+     */
+    [[nodiscard]] const std::vector<std::size_t> &roots() const { return roots_; }
+
+    /**
+     * @brief Returns the width of the buckets
+     */
+    [[nodiscard]] types::TraceTime bucketWidth() const { return bucketWidth_; }
+
+    /**
+     * @brief Calls a function for every bucket of a node overlapping a time window
+     *
+     * @param node Index of the node
+     * @param from Start of the window
+     * @param to End of the window
+     * @param fn Function called with the start, the end and the aggregate of every bucket
+     */
+    template<typename F>
+    void forEachBucket(std::size_t node, types::TraceTime from, types::TraceTime to, F fn) const {
+        aggregateOnce();
+        const auto &buckets = buckets_[node];
+        if (buckets.empty() || to <= from) {
+            return;
+        }
+
+        auto first = static_cast<std::size_t>(std::max<decltype(from.count())>(from.count(), 0) / bucketWidth_.count());
+        auto last = std::min(static_cast<std::size_t>((to.count() - 1) / bucketWidth_.count()), buckets.size() - 1);
+        for (auto i = first; i <= last; ++i) {
+            fn(bucketWidth_ * i, bucketWidth_ * (i + 1), buckets[i]);
+        }
+    }
+
+    /**
+     * @brief Returns the dominant regions of a node as slots
+     *
+     * Consecutive buckets with the same dominant region are joined into a single slot.
+     *
+     * @param node Index of the node
+     * @param from Start of the window
+     * @param to End of the window
+     * @param definitions Definitions the region indices refer to
+     * @return The slots of the dominant regions overlapping the window
+     */
+    [[nodiscard]] SlotStore aggregatedSlots(std::size_t node, types::TraceTime from, types::TraceTime to,
+                                            const DefinitionRegistry *definitions) const;
+
+private:
+    std::size_t addNode(const otf2::definition::system_tree_node &definition,
+                        std::map<std::uint64_t, std::size_t> &indices);
+
+    std::size_t countRanks(std::size_t node);
+
+    void aggregateOnce() const;
+
+    void aggregate(std::size_t node) const;
+
+    [[nodiscard]] std::vector<Bucket> rankBuckets(const SlotStore &slots) const;
+
+private:
+    std::vector<Node> nodes_;
+    std::vector<std::size_t> roots_;
+
+    /**
+     * Slots the aggregates are built from
+     */
+    const std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> *slots_ = nullptr;
+
+    /**
+     * Aggregates per node, built once by aggregateOnce()
+     */
+    mutable std::vector<std::vector<Bucket>> buckets_;
+    std::unique_ptr<std::once_flag> aggregated_ = std::make_unique<std::once_flag>();
+
+    types::TraceTime bucketWidth_{1};
+    std::size_t bucketCount_ = 0;
+};
+
+#endif //MOTIV_SYSTEMTREE_HPP
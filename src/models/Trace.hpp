@@ -22,12 +22,17 @@
 #include <vector>
 #include <ranges>
 #include "Slot.hpp"
+#include "SlotPyramid.hpp"
+#include "SlotStore.hpp"
 #include "src/models/communication/Communication.hpp"
 #include "src/models/communication/CollectiveCommunicationEvent.hpp"
 #include "Range.hpp"
 #include "TimedElement.hpp"
 
 
+class DefinitionRegistry;
+class SystemTree;
+
 /**
  * @brief A comparator for otf2::definition::location_group objects
  */
@@ -56,9 +61,9 @@ public:
      *
      * This pure virtual function returns a map of slots of the current trace. The function has to be implemented in the derived classes.
      *
-     * @return A map of slots of the current trace.
+     * @return A map of slots of the current trace, stored per location group.
      */
-    [[nodiscard]] virtual std::map<otf2::definition::location_group*, Range<Slot*>, LocationGroupCmp> getSlots() const = 0;
+    [[nodiscard]] virtual const std::map<otf2::definition::location_group*, SlotStore, LocationGroupCmp> &getSlots() const = 0;
 
     /**
      * @brief Returns communication objects of the current trace.
@@ -97,6 +102,39 @@ public:
      * @return A new Trace object that only contains elements within the given time range.
      */
     [[nodiscard]] virtual Trace* subtrace(otf2::chrono::duration from, otf2::chrono::duration to) = 0;
+
+    /**
+     * @brief Returns the level of detail pyramid of the slots of a location group
+     *
+     * Only traces covering the entire runtime provide pyramids, the levels of a pyramid span the entire trace.
+     *
+     * @return The pyramid of the slots of the given location group, nullptr if there is none
+     */
+    [[nodiscard]] virtual const SlotPyramid *getPyramid(otf2::definition::location_group *) const {
+        return nullptr;
+    }
+
+    /**
+     * @brief Returns the system tree of the location groups with aggregates of its nodes
+     *
+     * Only traces covering the entire runtime provide a system tree.
+     *
+     * @return The system tree, nullptr if there is none
+     */
+    [[nodiscard]] virtual const SystemTree *getSystemTree() const {
+        return nullptr;
+    }
+
+    /**
+     * @brief Returns the definitions the slots and communications of the trace point into
+     *
+     * Only traces owning their definitions provide them, traces derived from them share the definitions of the slots.
+     *
+     * @return The definition registry, nullptr if the trace does not own one
+     */
+    [[nodiscard]] virtual DefinitionRegistry *getDefinitions() const {
+        return nullptr;
+    }
 };
 
 
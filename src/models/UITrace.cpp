@@ -16,25 +16,24 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "UITrace.hpp"
-#include "src/utils.hpp"
+#include "PixelBuckets.hpp"
 
-#include <QDebug>
+#include <algorithm>
 
-UITrace::UITrace(std::map<otf2::definition::location_group *, std::vector<Slot *>, LocationGroupCmp> slotsVec,
+UITrace::UITrace(std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots,
                  const Range<Communication *> &communications,
                  const Range<CollectiveCommunicationEvent *> &collectiveCommunications,
                  const otf2::chrono::duration &runtime, const otf2::chrono::duration &startTime,
-                 const otf2::chrono::duration &timePerPx) :
+                 const otf2::chrono::duration &timePerPx, std::unique_ptr<ElementArena> arena) :
     SubTrace(),
-    timePerPx_(timePerPx) {
+    timePerPx_(timePerPx),
+    arena_(std::move(arena)) {
     communications_ = communications;
     collectiveCommunications_ = collectiveCommunications;
     runtime_ = runtime;
     startTime_ = startTime;
-
-    for (auto &item: slotsVec) {
-        slots_.insert({item.first, Range(item.second)});
-    }
+    slots_ = std::move(slots);
+    buildIndices();
 }
 UITrace *UITrace::forResolution(Trace *trace, int width) {
     return forResolution(trace, trace->getRuntime() / width);
@@ -42,175 +41,237 @@ UITrace *UITrace::forResolution(Trace *trace, int width) {
 
 UITrace *UITrace::forResolution(Trace *trace, otf2::chrono::duration timePerPixel) {
 
-    // Optimize slots
+    // Optimize slots, a level of the pyramid already summarizes slots too short for the resolution
     auto minDuration = timePerPixel * MIN_SLOT_SIZE_PX;
-    std::map<otf2::definition::location_group *, std::vector<Slot *>, LocationGroupCmp> newSlots;
+    std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> newSlots;
     for (const auto &item: trace->getSlots()) {
-        auto locationGroup = item.first;
-        auto slots = item.second;
-        auto newSlotsForRank = optimize<Slot, SlotKind>(
-            minDuration,
-            slots,
-            &Slot::getKind,
-            &UITrace::aggregateSlots);
-
-        newSlots.insert({locationGroup, newSlotsForRank});
+        const auto *pyramid = trace->getPyramid(item.first);
+        const auto *level = pyramid ? pyramid->level(minDuration) : nullptr;
+        newSlots.insert({item.first, optimizeSlots(minDuration, level ? level->slots : item.second)});
     }
 
+    return withCommunications(newSlots, trace->getCommunications(), trace->getCollectiveCommunications(),
+                              trace->getRuntime(), trace->getStartTime(), timePerPixel);
+}
 
-    // Optimize communications.
-    // Optimization is done per rank of the starting event. This is beneficial if few 1:n communications occur.
-    // 1:n communications are only visible with a higher zoom level.
-    minDuration = timePerPixel * MIN_COMMUNICATION_SIZE_PX;
-    auto communicationsByRank = groupBy<Communication *, otf2::reference<otf2::definition::location_group>>(
-        trace->getCommunications(),
-        [](const Communication *c) { return c->getStartEvent()->getLocation()->location_group().ref(); },
-        [](const Communication *l, const Communication *r) {
-            auto rankL = l->getStartEvent()->getLocation()->location_group().ref();
-            auto rankR = r->getStartEvent()->getLocation()->location_group().ref();
-
-            if (rankL == rankR) {
-                return l->getStartTime() < r->getStartTime();
-            }
-
-            return rankL < rankR;
-        });
-
-    std::vector<Communication *> newCommunications;
-    for (const auto &item: communicationsByRank) {
-        auto communications = item.second;
-        auto newCommunicationsForRank = optimize<Communication>(
-            minDuration,
-            communications,
-            [](Communication *starter, std::vector<Communication *> &) { return starter; });
-        newCommunications.insert(newCommunications.end(), newCommunicationsForRank.begin(),
-                                 newCommunicationsForRank.end());
-    }
+UITrace *UITrace::forWindow(SubTrace *trace, otf2::chrono::duration from, otf2::chrono::duration to,
+                            otf2::chrono::duration timePerPixel,
+                            const std::unordered_set<otf2::definition::location_group *> *locationGroups,
+                            const std::vector<bool> *regions) {
 
+    // Optimize slots, only the slots of the level of the pyramid matching the resolution are visited
+    auto minDuration = timePerPixel * MIN_SLOT_SIZE_PX;
+    std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> newSlots;
+    for (const auto &item: trace->getSlots()) {
+        // Location groups out of view keep their place without slots
+        if (locationGroups && !locationGroups->contains(item.first)) {
+            newSlots.insert({item.first, SlotStore(item.second.definitions())});
+            continue;
+        }
 
-    // Optimize collective communications
-    minDuration = timePerPixel * MIN_COLLECTIVE_EVENT_SIZE_PX;
-    auto newCollectiveCommunications = optimize<CollectiveCommunicationEvent>(minDuration,
-                                                                              trace->getCollectiveCommunications(),
-                                                                              &UITrace::aggregateCollectiveCommunications);
+        newSlots.insert({item.first, optimizeSlots(minDuration, windowSlots(trace, item.first, item.second, from, to,
+                                                                            minDuration, regions))});
+    }
 
-    return new UITrace(newSlots, Range(newCommunications), Range(newCollectiveCommunications),
-                       trace->getRuntime(), trace->getStartTime(), timePerPixel);
+    return withCommunications(newSlots, trace->getCommunications(from, to),
+                              trace->getCollectiveCommunications(from, to), to - from, from, timePerPixel);
 }
 
-template<class T>
-requires std::is_base_of_v<TimedElement, T>
-std::vector<T *> UITrace::optimize(types::TraceTime minDuration,
-                                   Range<T *> elements,
-                                   std::function<T *(T *, std::vector<T *> &stats)> aggregate) {
-    // This optimization implementation does not group elements in an interval. To not replicate code, it calls the
-    // overload that groups and groups all elements into a single group.
-    return optimize<T, uint8_t>(
-        minDuration,
-        elements,
-        [](const T *) { return 0; },
-        [aggregate](T *starter, std::map<uint8_t, std::vector<T *>> &stats) {
-            return aggregate(starter, stats[0]);
-        });
-}
+UITrace *UITrace::forPan(const UITrace *previous, SubTrace *trace, otf2::chrono::duration from,
+                         otf2::chrono::duration to, otf2::chrono::duration timePerPixel,
+                         const std::unordered_set<otf2::definition::location_group *> *locationGroups,
+                         const std::vector<bool> *regions) {
+    // Slots of the previous trace are only valid for the buckets they were summarized in
+    auto minDuration = timePerPixel * MIN_SLOT_SIZE_PX;
+    if (timePerPixel != previous->timePerPx_ || to - from != previous->getRuntime() || minDuration.count() <= 0) {
+        return nullptr;
+    }
 
-template<class T, typename K>
-requires std::is_base_of_v<TimedElement, T>
-std::vector<T *> UITrace::optimize(types::TraceTime minDuration,
-                                   Range<T *> &elements,
-                                   std::function<K(const T *)> keySelector,
-                                   std::function<T *(T *, std::map<K, std::vector<T *>> &stats)> aggregate) {
-    std::vector<T *> newElements;
-    T *intervalStarter = nullptr;
-    std::map<K, std::vector<T *>> stats;
-
-    for (const auto &element: elements) {
-        // Check whether the current element is outside the interval (start + minDuration). If so, group interval and continue.
-        if (intervalStarter != nullptr && (element->getStartTime() > intervalStarter->getStartTime() + minDuration)) {
-            newElements.push_back(aggregate(intervalStarter, stats));
-
-            stats.clear();
-            intervalStarter = nullptr;
-        }
+    // Buckets are aligned to multiples of their width. A bucket of the overlap summarizes the same slots in both windows
+    // if it starts after both windows begin and ends before both windows end.
+    auto width = minDuration.count();
+    auto overlapBegin = std::max(from, previous->getStartTime());
+    auto overlapEnd = std::min(to, previous->getEndTime());
+    auto retainedBegin = types::TraceTime((overlapBegin.count() + width - 1) / width * width);
+    auto retainedEnd = types::TraceTime(overlapEnd.count() / width * width);
+    if (retainedBegin >= retainedEnd) {
+        return nullptr;
+    }
 
-        // Check if element is too short
-        if (element->getDuration() < minDuration) {
-            if (intervalStarter == nullptr) {
-                intervalStarter = element;
-            }
+    std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> newSlots;
+    for (const auto &item: trace->getSlots()) {
+        if (locationGroups && !locationGroups->contains(item.first)) {
+            newSlots.insert({item.first, SlotStore(item.second.definitions())});
+            continue;
+        }
 
-            // Insert element in group
-            if (!stats.contains(keySelector(element))) {
-                stats.insert({keySelector(element), std::vector<T *>()});
-            }
+        auto retained = previous->slots_.find(item.first);
+        if (retained == previous->slots_.end()) {
+            return nullptr;
+        }
 
-            stats.at(keySelector(element)).push_back(element);
-        } else {
-            newElements.push_back(element);
+        // Slots starting before and after the retained buckets are collected and summarized anew
+        auto before = optimizeSlots(minDuration, windowSlots(trace, item.first, item.second, from, to, minDuration,
+                                                              regions, types::TraceTime::min(), retainedBegin));
+        auto after = optimizeSlots(minDuration, windowSlots(trace, item.first, item.second, from, to, minDuration,
+                                                             regions, retainedEnd, types::TraceTime::max()));
+
+        // The parts are sorted and follow each other in time, so they are simply concatenated
+        const auto &previousSlots = retained->second;
+        auto starts = previousSlots.starts();
+        auto first = static_cast<std::size_t>(std::lower_bound(starts.begin(), starts.end(), retainedBegin) - starts.begin());
+        auto last = static_cast<std::size_t>(std::lower_bound(starts.begin(), starts.end(), retainedEnd) - starts.begin());
+
+        SlotStore spliced(item.second.definitions());
+        spliced.reserve(before.size() + (last - first) + after.size());
+        for (std::size_t i = 0; i < before.size(); ++i) {
+            spliced.append(before, i);
+        }
+        for (auto i = first; i < last; ++i) {
+            spliced.append(previousSlots, i);
         }
+        for (std::size_t i = 0; i < after.size(); ++i) {
+            spliced.append(after, i);
+        }
+        spliced.sortByStart();
+        newSlots.insert({item.first, std::move(spliced)});
     }
 
-    // If the trace ends with a short interval it must be completed.
-    if (intervalStarter) {
-        newElements.push_back(aggregate(intervalStarter, stats));
-    }
-    return newElements;
+    return withCommunications(newSlots, trace->getCommunications(from, to),
+                              trace->getCollectiveCommunications(from, to), to - from, from, timePerPixel);
 }
 
-template<class T>
-requires std::is_base_of_v<TimedElement, T>
-static T *longest(std::vector<T *> ls) {
-    return *std::max_element(ls.begin(), ls.end(), [](T *lhs, T *rhs) {
-        return lhs->getDuration() > rhs->getDuration();
+SlotStore UITrace::windowSlots(SubTrace *trace, otf2::definition::location_group *locationGroup,
+                               const SlotStore &allSlots, types::TraceTime from, types::TraceTime to,
+                               types::TraceTime minDuration, const std::vector<bool> *regions,
+                               types::TraceTime firstStart, types::TraceTime lastStart) {
+    const auto *pyramid = trace->getPyramid(locationGroup);
+    const auto *level = pyramid ? pyramid->level(minDuration) : nullptr;
+    const auto &slots = level ? level->slots : allSlots;
+
+    // Slots starting in [firstStart, lastStart) end at or after firstStart, so only this part of the window is queried
+    auto queryFrom = firstStart > from ? firstStart - types::TraceTime(1) : from;
+    auto queryTo = std::min(to, lastStart);
+
+    SlotStore window(slots.definitions());
+    slots.forEachOverlapping(queryFrom, queryTo, [&](std::size_t i) {
+        auto region = slots.regionIndex(i);
+        if (regions && (region >= regions->size() || !(*regions)[region])) {
+            return;
+        }
+        auto start = slots.start(i);
+        if (start < firstStart || start >= lastStart || start >= to || slots.end(i) <= from) {
+            return;
+        }
+        window.append(slots, i);
     });
+    return window;
 }
 
-template<class T>
-requires std::is_base_of_v<TimedElement, T>
-static T *last(std::vector<T *> ls) {
-    return *std::max_element(ls.begin(), ls.end(), [](T *lhs, T *rhs) {
-        return lhs->getEndTime() < rhs->getEndTime();
+UITrace *UITrace::withCommunications(std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &slots,
+                                     Range<Communication *> communications,
+                                     Range<CollectiveCommunicationEvent *> collectiveCommunications,
+                                     otf2::chrono::duration runtime, otf2::chrono::duration startTime,
+                                     otf2::chrono::duration timePerPixel) {
+
+    // Optimize communications.
+    // Optimization is done per rank of the starting event. This is beneficial if few 1:n communications occur.
+    // 1:n communications are only visible with a higher zoom level.
+    auto rankOf = [](const Communication *c) { return c->getStartEvent()->getLocation()->location_group().ref(); };
+    std::vector<Communication *> communicationsByRank(communications.begin(), communications.end());
+    std::sort(communicationsByRank.begin(), communicationsByRank.end(), [&rankOf](const Communication *l, const Communication *r) {
+        auto rankL = rankOf(l);
+        auto rankR = rankOf(r);
+
+        if (rankL == rankR) {
+            return l->getStartTime() < r->getStartTime();
+        }
+
+        return rankL < rankR;
     });
-}
 
+    // A summarized interval is represented by its first communication
+    auto minDuration = timePerPixel * MIN_COMMUNICATION_SIZE_PX;
+    std::vector<Communication *> newCommunications;
+    using CommunicationBuckets = PixelBuckets<ElementBucketSource<Communication>>;
+    for (auto rankBegin = communicationsByRank.begin(); rankBegin != communicationsByRank.end();) {
+        auto rank = rankOf(*rankBegin);
+        auto rankEnd = std::find_if(rankBegin, communicationsByRank.end(), [&](const Communication *c) {
+            return rankOf(c) != rank;
+        });
 
-Slot *UITrace::aggregateSlots(const Slot *intervalStarter, std::map<SlotKind, std::vector<Slot *>> &stats) {
-    std::vector<Slot *>* elements;
-    // Order of importance if overlapping, the slot with the most important kind is shown.
-    // 1. MPI events, 2. OpenMP events 3. all other events
-    if (stats.contains(MPI)) {
-        elements = &stats.at(MPI);
-    } else if (stats.contains(OpenMP)) {
-        elements = &stats.at(OpenMP);
-    } else {
-        elements = &stats.at(Plain);
+        ElementBucketSource<Communication> source(std::span<Communication *const>(rankBegin, rankEnd));
+        CommunicationBuckets::run(source, minDuration,
+                                  [&](std::size_t i) { newCommunications.push_back(source[i]); },
+                                  [&](const CommunicationBuckets::Bucket &bucket) {
+                                      newCommunications.push_back(source[bucket.first]);
+                                  });
+        rankBegin = rankEnd;
     }
 
-    auto longestSlot = longest(*elements);
-    auto intervalEnder = last(*elements);
 
-    return new Slot(intervalStarter->startTime, intervalEnder->endTime, longestSlot->location, longestSlot->region);
+    // Optimize collective communications, summaries are owned by the new trace
+    auto arena = std::make_unique<ElementArena>();
+    minDuration = timePerPixel * MIN_COLLECTIVE_EVENT_SIZE_PX;
+    std::vector<CollectiveCommunicationEvent *> newCollectiveCommunications;
+    using CollectiveBuckets = PixelBuckets<ElementBucketSource<CollectiveCommunicationEvent>>;
+    ElementBucketSource<CollectiveCommunicationEvent> collectives(
+        std::span<CollectiveCommunicationEvent *const>(collectiveCommunications.begin(), collectiveCommunications.end()));
+    CollectiveBuckets::run(collectives, minDuration,
+                           [&](std::size_t i) { newCollectiveCommunications.push_back(collectives[i]); },
+                           [&](const CollectiveBuckets::Bucket &bucket) {
+                               newCollectiveCommunications.push_back(aggregateCollectiveCommunications(
+                                   *arena, collectives[bucket.first], collectives[bucket.longest[0]], bucket.end[0]));
+                           });
+
+    return new UITrace(std::move(slots), Range(std::move(newCommunications)),
+                       Range(std::move(newCollectiveCommunications)),
+                       runtime, startTime, timePerPixel, std::move(arena));
+}
+
+SlotStore UITrace::optimizeSlots(types::TraceTime minDuration, const SlotStore &slots) {
+    SlotStore newSlots(slots.definitions());
+
+    // Of overlapping slots, the slot with the most important kind is shown: 1. MPI events, 2. OpenMP events 3. all other
+    // events.
+    using Buckets = PixelBuckets<SlotBucketSource>;
+    Buckets::run(SlotBucketSource(slots), minDuration,
+                 [&](std::size_t i) { newSlots.append(slots, i); },
+                 [&](const Buckets::Bucket &bucket) {
+                     auto kind = bucket.dominant();
+                     auto longest = bucket.longest[kind];
+                     newSlots.push_back(slots.start(bucket.first), bucket.end[kind], slots.regionIndex(longest),
+                                        slots.depth(longest));
+                 });
+
+    // Long slots starting within a bucket were added before the summary of the bucket
+    newSlots.sortByStart();
+    return newSlots;
 }
 
 CollectiveCommunicationEvent *UITrace::aggregateCollectiveCommunications(
+    ElementArena &arena,
     const CollectiveCommunicationEvent *intervalStarter,
-    std::vector<CollectiveCommunicationEvent *> &stats) {
-    auto longestEvent = longest(stats);
-    auto intervalEnder = last(stats);
-
-    auto singleMember = new CollectiveCommunicationEvent::Member(intervalStarter->getStartTime(),
-                                                                 intervalEnder->getEndTime(),
-                                                                 longestEvent->getLocation());
+    const CollectiveCommunicationEvent *longestEvent,
+    types::TraceTime end) {
+    auto singleMember = arena.create<CollectiveCommunicationEvent::Member>(intervalStarter->getStartTime(), end,
+                                                                           longestEvent->getLocation());
 
     std::vector<CollectiveCommunicationEvent::Member *> singletonMembers;
     singletonMembers.push_back(singleMember);
 
-    return new CollectiveCommunicationEvent(
+    return arena.create<CollectiveCommunicationEvent>(
         singletonMembers, longestEvent->getLocation(), longestEvent->getCommunicator(),
         longestEvent->getOperation(), longestEvent->getRoot()
     );
 }
 
 Trace *UITrace::subtrace(otf2::chrono::duration from, otf2::chrono::duration to) {
-    return forResolution(SubTrace::subtrace(from, to), timePerPx_);
+    // The UITrace copies what it needs, the intermediate subtrace is not kept
+    std::unique_ptr<Trace> window(SubTrace::subtrace(from, to));
+    return forResolution(window.get(), timePerPx_);
+}
+
+std::size_t UITrace::arenaBytes() const {
+    return arena_ ? arena_->bytes() : 0;
 }
@@ -19,8 +19,12 @@
 #define MOTIV_UITRACE_HPP
 
 
+#include <memory>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
+#include "ElementArena.hpp"
 #include "SubTrace.hpp"
 #include "Range.hpp"
 
@@ -44,24 +48,29 @@
  *
  * Slots that would be rendered smaller than `MIN_SLOT_SIZE_PX` pixels are grouped together to a single slot.
  * Instead of all slots that fit inside `MIN_SLOT_SIZE_PX` the longest slot with the most important kind is shown.
+ *
+ * Elements synthesized while summarizing, e.g. collective communications, live in an arena owned by the UITrace. They
+ * are released together with the UITrace, so replacing the UITrace of a view releases everything that was created for
+ * it.
  */
 class UITrace : public SubTrace {
 private:
     /**
      * Creates a new instance of the `UITrace` class.
      *
-     * @param slotsVec vectors of grouped slots
+     * @param slots optimized slots grouped by location group
      * @param communications range of communications
      * @param collectiveCommunications range of collective communications
      * @param runtime runtime of the trace
      * @param startTime starttime of the trace
      * @param timePerPx duration that fits into one pixel
+     * @param arena arena owning the elements synthesized for the trace
      */
-    UITrace(std::map<otf2::definition::location_group *, std::vector<Slot *>, LocationGroupCmp> slotsVec,
+    UITrace(std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots,
             const Range<Communication *> &communications,
             const Range<CollectiveCommunicationEvent *> &collectiveCommunications,
             const otf2::chrono::duration &runtime, const otf2::chrono::duration &startTime,
-            const otf2::chrono::duration &timePerPx);
+            const otf2::chrono::duration &timePerPx, std::unique_ptr<ElementArena> arena);
 
 public:
     /**
@@ -87,73 +96,136 @@ public:
      */
     static UITrace *forResolution(Trace *trace, int width);
 
+    /**
+     * Creates a UITrace optimized for rendering performance of a time window of a trace.
+     *
+     * Unlike creating a subtrace first, only the elements overlapping the window are visited. If the trace provides
+     * level of detail pyramids, only the level matching the resolution is visited.
+     *
+     * Slots can be restricted to some location groups, e.g. the rows in view. The other location groups are kept with
+     * empty slots. Communications are not restricted to the location groups.
+     *
+     * Slots can also be restricted to some regions, e.g. the regions of the kinds shown by a filter. Slots of other
+     * regions are dropped before summarizing, so they do not hide the slots shown in their place. The levels of the
+     * pyramids keep a summary per kind, so this holds for every resolution.
+     *
+     * @param trace original trace
+     * @param from start of the window
+     * @param to end of the window
+     * @param timePerPixel duration that fits into one pixel
+     * @param locationGroups location groups to collect slots for, nullptr to collect the slots of all location groups
+     * @param regions mask of the regions to collect slots of indexed by region index, see
+     * DefinitionRegistry::regionMask(), nullptr to collect the slots of all regions
+     * @return the UITrace of the window
+     */
+    static UITrace *forWindow(SubTrace *trace, otf2::chrono::duration from, otf2::chrono::duration to,
+                              otf2::chrono::duration timePerPixel,
+                              const std::unordered_set<otf2::definition::location_group *> *locationGroups = nullptr,
+                              const std::vector<bool> *regions = nullptr);
+
+    /**
+     * Creates the UITrace of a window by panning a UITrace of a window of the same duration.
+     *
+     * Slots are summarized in buckets aligned to multiples of the duration of a pixel, so the buckets in the overlap of
+     * both windows do not change. Their slots are taken from the previous UITrace, only the slots of the newly exposed
+     * parts of the window and of the buckets at the borders of the overlap are collected and summarized. The result is
+     * the same as the one of forWindow(). Communications are collected for the entire window.
+     *
+     * @param previous UITrace of the trace with the same location groups and regions, created by forWindow() or forPan()
+     * @param trace original trace
+     * @param from start of the window
+     * @param to end of the window
+     * @param timePerPixel duration that fits into one pixel
+     * @param locationGroups location groups to collect slots for, see forWindow()
+     * @param regions mask of the regions to collect slots of, see forWindow()
+     * @return the UITrace of the window, nullptr if the windows differ in duration or resolution or do not overlap
+     */
+    static UITrace *forPan(const UITrace *previous, SubTrace *trace, otf2::chrono::duration from,
+                           otf2::chrono::duration to, otf2::chrono::duration timePerPixel,
+                           const std::unordered_set<otf2::definition::location_group *> *locationGroups = nullptr,
+                           const std::vector<bool> *regions = nullptr);
+
     /**
      * @copydoc Trace::subtrace()
      */
     Trace *subtrace(otf2::chrono::duration from, otf2::chrono::duration to) override;
 
+    /**
+     * Returns the memory used by the elements synthesized for this trace in bytes.
+     */
+    [[nodiscard]] std::size_t arenaBytes() const;
+
 private:
     /**
      * Backing field. Stores the time that can be represented per pixel.
      */
     otf2::chrono::duration timePerPx_;
+    /**
+     * Backing field. Owns the elements synthesized for this trace.
+     */
+    std::unique_ptr<ElementArena> arena_;
     /**
      * Aggregates collective communications in an interval into a new summarized collective communication event.
      *
-     * Creates a new collective communication event representing all events in @c stats
+     * @param arena Arena to create the event in
      * @param intervalStarter First event in the interval
-     * @param stats All other events in this interval
+     * @param longestEvent Longest event in the interval
+     * @param end Latest end of the events in the interval
      * @return A new collective communication event summarizing all events in the interval
      */
     static CollectiveCommunicationEvent *
-    aggregateCollectiveCommunications(const CollectiveCommunicationEvent *intervalStarter,
-                                      std::vector<CollectiveCommunicationEvent *> &stats);
+    aggregateCollectiveCommunications(ElementArena &arena,
+                                      const CollectiveCommunicationEvent *intervalStarter,
+                                      const CollectiveCommunicationEvent *longestEvent,
+                                      types::TraceTime end);
 
     /**
-     * Aggregates slots in an interval respecting stats
+     * Creates a UITrace from optimized slots, optimizing the communications.
      *
-     * Creates a new slot representing all slots in {@c stats} by ordering them by priority with their kind
-     * @param intervalStarter First slot in the interval
-     * @param stats All other slots grouped by kind in the interval
-     * @return A new slot summarizing all slots in the interval
+     * @param slots Optimized slots
+     * @param communications All communications to be rendered
+     * @param collectiveCommunications All collective communications to be rendered
+     * @param runtime Runtime of the trace
+     * @param startTime Start time of the trace
+     * @param timePerPixel duration that fits into one pixel
+     * @return the UITrace
      */
-    static Slot *aggregateSlots(const Slot *intervalStarter, std::map<SlotKind, std::vector<Slot *>> &stats);
+    static UITrace *withCommunications(std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> &slots,
+                                       Range<Communication *> communications,
+                                       Range<CollectiveCommunicationEvent *> collectiveCommunications,
+                                       otf2::chrono::duration runtime, otf2::chrono::duration startTime,
+                                       otf2::chrono::duration timePerPixel);
 
     /**
-     * Collects and optimizes timed elements to small to be rendered.
-     * @tparam T Type of {@c TimedElement}
-     * @param minDuration Minimum duration of a {@c TimedElement} to be rendered
-     * @param elements All elements to be rendered
-     * @param aggregate Function to aggregate multiple elements into one
-     * @return @c elements but to short element are summarized
+     * Collects the slots of a location group overlapping a window from the pyramid level matching the resolution.
+     *
+     * @param trace original trace
+     * @param locationGroup the location group
+     * @param allSlots all slots of the location group, used if there is no matching level
+     * @param from start of the window
+     * @param to end of the window
+     * @param minDuration minimum duration of a slot to be rendered
+     * @param regions mask of the regions to collect slots of, nullptr to collect the slots of all regions
+     * @param firstStart only slots starting at or after this time are collected
+     * @param lastStart only slots starting before this time are collected
+     * @return the slots sorted by start time
      */
-    template<class T>
-    requires std::is_base_of_v<TimedElement, T>
-    static std::vector<T *> optimize(
-        types::TraceTime minDuration,
-        Range<T *> elements,
-        std::function<T *(T *, std::vector<T *> &stats)> aggregate);
+    static SlotStore windowSlots(SubTrace *trace, otf2::definition::location_group *locationGroup,
+                                 const SlotStore &allSlots, types::TraceTime from, types::TraceTime to,
+                                 types::TraceTime minDuration, const std::vector<bool> *regions,
+                                 types::TraceTime firstStart = types::TraceTime::min(),
+                                 types::TraceTime lastStart = types::TraceTime::max());
 
     /**
-     * Collects and optimizes timed elements to small to be rendered.
+     * Collects and optimizes slots to small to be rendered.
      *
-     * Elements in one interval (shortest render time) are grouped with a function @c keySelector. The resulting map is
-     * passed to @c aggregate
-     * @tparam T Type of {@c TimedElement}
-     * @tparam K Type of group by key
-     * @param minDuration Minimum duration of a {@c TimedElement} to be rendered
-     * @param elements All elements to be rendered
-     * @param keySelector Function to select a key to group by
-     * @param aggregate Function to aggregate multiple elements into one
-     * @return @c elements but to short element are summarized
+     * Slots shorter than @c minDuration are summarized per interval of this duration by a single slot, see PixelBuckets.
+     * Of all slots in the interval, the longest slot with the most important kind is shown.
+     * @param minDuration Minimum duration of a slot to be rendered
+     * @param slots All slots to be rendered, sorted by start time
+     * @return @c slots but to short slots are summarized, sorted by start time
      */
-    template<class T, typename K>
-    requires std::is_base_of_v<TimedElement, T>
-    static std::vector<T *> optimize(
-        types::TraceTime minDuration,
-        Range<T *> &elements,
-        std::function<K(const T *)> keySelector,
-        std::function<T *(T *, std::map<K, std::vector<T *>> &stats)> aggregate);
+    static SlotStore optimizeSlots(types::TraceTime minDuration, const SlotStore &slots);
 };
 
 #endif //MOTIV_UITRACE_HPP
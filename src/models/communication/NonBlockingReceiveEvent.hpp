@@ -48,6 +48,7 @@ public:
             BUILDER_FIELD(otf2::chrono::duration, end)
             BUILDER_FIELD(otf2::definition::location*, location)
             BUILDER_FIELD(types::communicator*, communicator)
+            BUILDER_OPTIONAL_FIELD(uint32_t, tag) // The tag is needed to match the sending call in order.
             BUILDER_OPTIONAL_FIELD(uint32_t, sender), // The sender field is needed to match the sending call. The
                                                       // location instance of the sender is only known in the
                                                       // send event.
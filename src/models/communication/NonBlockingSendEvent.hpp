@@ -45,6 +45,7 @@ public:
             BUILDER_FIELD(otf2::chrono::duration, end)
             BUILDER_FIELD(otf2::definition::location*, location)
             BUILDER_FIELD(types::communicator*, communicator)
+            BUILDER_OPTIONAL_FIELD(uint32_t, tag) // The tag is needed to match the receiving call in order.
             BUILDER_OPTIONAL_FIELD(uint32_t, receiver), // The receiver field is needed to match the receiving call. The
                                                         // location instance of the receiver is only known in the
                                                         // receive event.
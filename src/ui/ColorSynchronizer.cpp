@@ -18,6 +18,7 @@
 
 #include "src/models/AppSettings.hpp"
 #include "src/models/ColorMap.hpp"
+#include "src/models/DefinitionRegistry.hpp"
 #include "src/ui/ColorSynchronizer.hpp"
 #include "src/ui/Constants.hpp"
 
@@ -32,74 +33,51 @@ ColorSynchronizer* ColorSynchronizer::getInstance(){
 
 void ColorSynchronizer::synchronizeColors(const std::string& function, const QColor& color){
     if(!data_) return;
-        ColorMap *map = ColorMap::getInstance();
-        map->setColor(QString::fromStdString(function), color);
-        for (const auto &item: data_->getFullTrace()->getSlots()) {
-            for (const auto &slot: item.second) {
-                if(slot->region->name().str()==function) slot->setColor(color);                    
-            }
+    // The ColorMap keeps the color for future traces, the palette entry of the function recolors the current one
+    ColorMap *map = ColorMap::getInstance();
+    map->setColor(QString::fromStdString(function), color);
+    if (auto definitions = data_->getFullTrace()->getDefinitions()) {
+        if (auto paletteIndex = definitions->paletteIndexOf(function)) {
+            definitions->setPaletteColor(*paletteIndex, color);
         }
+    }
     data_->colorChanged();
 }
 
 void ColorSynchronizer::synchronizeColors(const QColor& color, bool all){
     if(!data_) return;
-     ColorMap *map = ColorMap::getInstance();
+    auto definitions = data_->getFullTrace()->getDefinitions();
+    if(!definitions) return;
+    ColorMap *map = ColorMap::getInstance();
 
-        for (const auto &item: data_->getFullTrace()->getSlots()) {     
-            for (const auto &slot: item.second) {               
-                if(slot->getKind()==Plain||slot->getKind()==None||all) {
-                    slot->setColor(color);
-                    QString function_= QString::fromStdString(slot->region->name().str());
-                    map->setColor(function_, color);
-                }
-            }
+    const auto &palette = definitions->palette();
+    for (std::uint32_t paletteIndex = 0; paletteIndex < palette.size(); ++paletteIndex) {
+        if (!palette[paletteIndex].used) continue;
+        const auto &attributes = definitions->regionAttributes(palette[paletteIndex].region);
+        if(attributes.kind==Plain||attributes.kind==None||all) {
+            map->setColor(attributes.name, color);
+            definitions->setPaletteColor(paletteIndex, color);
         }
+    }
     data_->colorChanged();
 }
 
 
 void ColorSynchronizer::synchronizeColors(){
     if(!data_) return;
-    ColorMap *map = ColorMap::getInstance();
-
-        for (const auto &item: data_->getFullTrace()->getSlots()) {     
-            for (const auto &slot: item.second) {
-                QString function_= QString::fromStdString(slot->region->name().str());             
-                slot->setColor(map->getColor(function_));                
-            }
-        }    
+    if (auto definitions = data_->getFullTrace()->getDefinitions()) {
+        definitions->resolveColors();
+    }
     data_->colorChanged();
 }
 
 void ColorSynchronizer::reCalculateColors(){
     if(!data_) return;
 
-    ColorMap *map = ColorMap::getInstance();    
-        for (const auto &item: data_->getFullTrace()->getSlots()) {     
-            for (const auto &slot: item.second) {
-                QString function_= QString::fromStdString(slot->region->name().str());
-                QColor color_ = map->getColor(function_);
-                if(color_.isValid()) slot->setColor(color_);
-                else {        
-                    switch(slot->getKind()){
-                        case ::MPI:
-                            slot->setColor(colors::COLOR_SLOT_MPI);
-                            map->addColor(function_,slot->getColor());
-                            break;
-                        case ::OpenMP:
-                            slot->setColor(colors::COLOR_SLOT_OPEN_MP);
-                            map->addColor(function_,slot->getColor());
-                            break;
-                        case ::None:
-                        case ::Plain:
-                            map->addColor(function_, QColor());
-                            slot->setColor(map->getColor(function_));
-                            break;                      
-                    }                   
-                }
-            }
-        }
+    // Regions without a color in the ColorMap get the default color of their kind
+    if (auto definitions = data_->getFullTrace()->getDefinitions()) {
+        definitions->resolveColors();
+    }
     data_->colorChanged();
 }
 
@@ -34,7 +34,7 @@ public:
     static ColorSynchronizer* getInstance(); 
 
     /**
-     * @brief Updates the color of all slots that represent the given function to the given color
+     * @brief Updates the color of the given function in the ColorMap and in the palette of the trace
      */
     void synchronizeColors(const std::string& function, const QColor& color);
     
@@ -46,12 +46,12 @@ public:
     void synchronizeColors(const QColor&, bool = false);
     
     /**
-     * @brief Recolors all slots based on the ColorMap structure
+     * @brief Updates the palette of the trace from the ColorMap and repaints all slots
      */   
     void synchronizeColors();
 
     /**
-     * @brief Recalculates and updates the colors of all slots after deleting the custom colors
+     * @brief Recalculates the palette of the trace from the ColorMap after deleting the custom colors
      */
     void reCalculateColors();
 
@@ -18,6 +18,7 @@
 #ifndef MOTIV_CONSTANTS_HPP
 #define MOTIV_CONSTANTS_HPP
 
+#include <cstddef>
 
 namespace layers {
     const int Z_LAYER_HIGHLIGHTED_OFFSET = 20;
@@ -28,6 +29,23 @@ namespace layers {
     const int Z_LAYER_SELECTION = 200;
 }
 
+namespace layout {
+    const int ROW_HEIGHT = 30;
+    const int ROW_OFFSET = 20;
+    const int STRIP_HEIGHT = 2 * ROW_HEIGHT;
+    const double MIN_SLOT_WIDTH = 5.0;
+    const std::size_t ROW_MARGIN = 16;
+    const std::size_t INITIAL_ROWS = 64;
+    const std::size_t MAX_FLAT_ROWS = 256;
+    const int DEFAULT_RESOLUTION = 1920;
+    const std::size_t SELECTION_CACHE_BYTES = std::size_t(256) << 20;
+    const std::size_t MAX_HISTORY = 64;
+    const int HISTORY_COALESCE_MS = 500;
+    const int PREFETCH_DELAY_MS = 250;
+    const int FRAME_BUDGET_MS = 16;
+    const int COARSE_RESOLUTION_DIVISOR = 4;
+}
+
 namespace colors {
     const QColor COLOR_SLOT_MPI = QColor::fromRgb(0xCDDC39);
     const QColor COLOR_SLOT_OPEN_MP = QColor::fromRgb(0xFF5722);
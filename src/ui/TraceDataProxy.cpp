@@ -16,22 +16,78 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TraceDataProxy.hpp"
+#include "src/models/DefinitionRegistry.hpp"
 #include "src/models/UITrace.hpp"
+#include "src/ui/Constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <tuple>
+
+/**
+ * Returns the approximate memory used by a selection: the slots, the references to communications, their indices and
+ * the elements synthesized for the selection
+ */
+static std::size_t estimatedBytes(Trace *selection, const std::map<std::size_t, SlotStore> &aggregates) {
+    std::size_t bytes = 0;
+    for (const auto &[locationGroup, slots]: selection->getSlots()) {
+        bytes += slots.size() * (2 * sizeof(types::TraceTime) + 2 * sizeof(std::uint32_t));
+    }
+    for (const auto &[node, slots]: aggregates) {
+        bytes += slots.size() * (2 * sizeof(types::TraceTime) + 2 * sizeof(std::uint32_t));
+    }
+    bytes += selection->getCommunications().size() * sizeof(Communication *);
+    bytes += selection->getCollectiveCommunications().size() * sizeof(CollectiveCommunicationEvent *);
+    if (auto subTrace = dynamic_cast<SubTrace *>(selection)) {
+        bytes += subTrace->indexBytes();
+    }
+    if (auto uiTrace = dynamic_cast<UITrace *>(selection)) {
+        bytes += uiTrace->arenaBytes();
+    }
+    return bytes;
+}
 
 TraceDataProxy::TraceDataProxy(FileTrace *trace, ViewSettings *settings, QObject *parent)
     : QObject(parent), trace(trace), settings(settings), begin(trace->getStartTime()),
-      end(trace->getStartTime() + trace->getRuntime()) {
-    updateSelection();
-    connect(this, &TraceDataProxy::colorChanged, this, &TraceDataProxy::updateSelection);
+      end(trace->getStartTime() + trace->getRuntime()), infoElement(trace) {
+    selectionPool.setMaxThreadCount(1);
+    endRow = layout::INITIAL_ROWS;
+    initRows();
+    updateRegionMask();
+
+    // Prefetching must not slow down the selection that is actually requested
+    prefetchPool.setMaxThreadCount(1);
+    prefetchPool.setThreadPriority(QThread::LowPriority);
+    prefetchTimer.setSingleShot(true);
+    prefetchTimer.setInterval(layout::PREFETCH_DELAY_MS);
+    connect(&prefetchTimer, &QTimer::timeout, this, &TraceDataProxy::prefetch);
+
+    // Views expect a selection right away, so the first one is computed synchronously
+    QElapsedTimer timer;
+    timer.start();
+    auto computed = compute(this->trace, selectionKey(), visibleLocationGroups(), {}, regionMask.get());
+    computeTime = timer.elapsed();
+    selection = computed.selection;
+    selectionTrace = computed.source;
+    selectionShown = computed.key;
+
+    // Node rows are shown empty until the worker built their aggregates
+    if (visibleNodes().empty()) {
+        cacheSelection(computed);
+    } else {
+        computeSelection();
+    }
 }
 
 TraceDataProxy::~TraceDataProxy() {
-    delete this->selection;
-    delete this->trace;
+    prefetchPool.clear();
+    prefetchPool.waitForDone();
+    selectionPool.waitForDone();
 }
 
 Trace *TraceDataProxy::getSelection() const {
-    return this->selection;
+    return this->selection.get();
 }
 
 types::TraceTime TraceDataProxy::getBegin() const {
@@ -59,20 +115,527 @@ types::TraceTime TraceDataProxy::getTotalRuntime() const {
     return trace->getRuntime();
 }
 
+const std::vector<TraceDataProxy::Row> &TraceDataProxy::getRows() const {
+    return rows;
+}
+
+std::size_t TraceDataProxy::getRowOf(otf2::reference<otf2::definition::location_group> locationGroup) const {
+    auto it = rowIndices.find(static_cast<std::uint64_t>(locationGroup.get()));
+    return it != rowIndices.end() ? it->second : rows.size();
+}
+
+const SystemTree *TraceDataProxy::getSystemTree() const {
+    return trace->getSystemTree();
+}
+
+const SlotStore *TraceDataProxy::getAggregatedSlots(std::size_t node) const {
+    if (!selectionAggregates) {
+        return nullptr;
+    }
+    auto it = selectionAggregates->find(node);
+    return it != selectionAggregates->end() ? &it->second : nullptr;
+}
+
+bool TraceDataProxy::isExpanded(std::size_t node) const {
+    return node < expanded.size() && expanded[node];
+}
+
+const Trace *TraceDataProxy::getPannedFrom() const {
+    return pannedFrom.get();
+}
+
+bool TraceDataProxy::canZoomBack() const {
+    return !backHistory.empty();
+}
+
+bool TraceDataProxy::canZoomForward() const {
+    return !forwardHistory.empty();
+}
+
+int TraceDataProxy::getResolution() const {
+    int resolution = 0;
+    for (const auto &[view, pixels]: resolutions) {
+        resolution = qMax(resolution, pixels);
+    }
+    return resolution > 0 ? resolution : layout::DEFAULT_RESOLUTION;
+}
+
+void TraceDataProxy::setResolution(QObject *view, int pixels) {
+    auto oldResolution = getResolution();
+
+    if (pixels > 0) {
+        auto [it, added] = resolutions.try_emplace(view, pixels);
+        it->second = pixels;
+        if (added) {
+            connect(view, &QObject::destroyed, this, [this, view] { setResolution(view, 0); });
+        }
+    } else if (resolutions.erase(view) > 0) {
+        disconnect(view, &QObject::destroyed, this, nullptr);
+    }
+
+    if (getResolution() != oldResolution) {
+        updateSelection();
+    }
+}
+
+void TraceDataProxy::initRows() {
+    auto tree = trace->getSystemTree();
+    expanded.assign(tree ? tree->nodes().size() : 0, false);
+
+    // Few location groups are shown directly, see updateRows()
+    if (tree && trace->getSlots().size() > layout::MAX_FLAT_ROWS) {
+        // Expand level by level as long as the rows fit, a single row is always expanded
+        std::vector<std::size_t> level = tree->roots();
+        auto rowCount = level.size();
+        while (!level.empty()) {
+            std::size_t added = 0;
+            for (auto node: level) {
+                added += tree->nodes()[node].children.size() + tree->nodes()[node].locationGroups.size();
+            }
+            if (rowCount > 1 && rowCount + added > layout::MAX_FLAT_ROWS) {
+                break;
+            }
+
+            std::vector<std::size_t> next;
+            for (auto node: level) {
+                expanded[node] = true;
+                const auto &children = tree->nodes()[node].children;
+                next.insert(next.end(), children.begin(), children.end());
+            }
+            rowCount += added;
+            level = std::move(next);
+        }
+    }
+
+    updateRows();
+}
+
+void TraceDataProxy::updateRows() {
+    rows.clear();
+    rowIndices.clear();
+
+    auto tree = trace->getSystemTree();
+    if (!tree || trace->getSlots().size() <= layout::MAX_FLAT_ROWS) {
+        for (const auto &item: trace->getSlots()) {
+            rowIndices[static_cast<std::uint64_t>(item.first->ref().get())] = rows.size();
+            rows.push_back({item.first, SystemTree::NO_NODE, 0});
+        }
+        return;
+    }
+
+    // Location groups of collapsed nodes map to the row of the node
+    auto mapLocationGroups = [this, tree](std::size_t node, std::size_t row, auto &self) -> void {
+        for (auto locationGroup: tree->nodes()[node].locationGroups) {
+            rowIndices[static_cast<std::uint64_t>(locationGroup->ref().get())] = row;
+        }
+        for (auto child: tree->nodes()[node].children) {
+            self(child, row, self);
+        }
+    };
+
+    auto addNode = [this, tree, &mapLocationGroups](std::size_t node, auto &self) -> void {
+        const auto &treeNode = tree->nodes()[node];
+        auto row = rows.size();
+        rows.push_back({nullptr, node, treeNode.depth});
+        if (!expanded[node]) {
+            mapLocationGroups(node, row, mapLocationGroups);
+            return;
+        }
+
+        for (auto child: treeNode.children) {
+            self(child, self);
+        }
+        for (auto locationGroup: treeNode.locationGroups) {
+            rowIndices[static_cast<std::uint64_t>(locationGroup->ref().get())] = rows.size();
+            rows.push_back({locationGroup, SystemTree::NO_NODE, treeNode.depth + 1});
+        }
+    };
+
+    for (auto root: tree->roots()) {
+        addNode(root, addNode);
+    }
+}
+
+std::unordered_set<otf2::definition::location_group *> TraceDataProxy::visibleLocationGroups() const {
+    std::unordered_set<otf2::definition::location_group *> locationGroups;
+    for (auto row = firstRow; row < qMin(endRow, rows.size()); ++row) {
+        if (rows[row].locationGroup) {
+            locationGroups.insert(rows[row].locationGroup);
+        }
+    }
+    return locationGroups;
+}
+
+std::vector<std::size_t> TraceDataProxy::visibleNodes() const {
+    std::vector<std::size_t> nodes;
+    for (auto row = firstRow; row < qMin(endRow, rows.size()); ++row) {
+        if (rows[row].node != SystemTree::NO_NODE) {
+            nodes.push_back(rows[row].node);
+        }
+    }
+    return nodes;
+}
+
+void TraceDataProxy::toggleRow(std::size_t row) {
+    if (row >= rows.size() || rows[row].node == SystemTree::NO_NODE) {
+        return;
+    }
+
+    expanded[rows[row].node] = !expanded[rows[row].node];
+    updateRows();
+    Q_EMIT rowsChanged();
+    clearSelectionCache();
+    updateSelection();
+}
+
+TraceDataProxy::SelectionKey TraceDataProxy::selectionKey() const {
+    return {begin, end, settings->getFilter().getSlotKinds(), getResolution(), firstRow, endRow};
+}
+
+void TraceDataProxy::updateRegionMask() {
+    auto definitions = trace->getDefinitions();
+    auto kinds = settings->getFilter().getSlotKinds();
+
+    // Unfiltered selections do not test the regions of their slots at all
+    if (!definitions || kinds == FILTER_DEFAULT) {
+        regionMask.reset();
+        return;
+    }
+    regionMask = std::make_shared<const std::vector<bool>>(definitions->regionMask(kinds));
+}
+
+void TraceDataProxy::clearSelectionCache() {
+    selectionCache.clear();
+    selectionCacheBytes = 0;
+    ++cacheEpoch;
+
+    // The next selection differs from the shown one in more than its window
+    selectionShown = SelectionKey();
+}
+
+void TraceDataProxy::cacheSelection(const CachedSelection &computed) {
+    selectionCache.push_back(computed);
+    selectionCacheBytes += computed.bytes;
+
+    // The least recently used selections are dropped first, the new one is kept even if it exceeds the budget
+    auto evicted = selectionCache.begin();
+    while (selectionCacheBytes > layout::SELECTION_CACHE_BYTES && evicted + 1 != selectionCache.end()) {
+        selectionCacheBytes -= evicted->bytes;
+        ++evicted;
+    }
+    selectionCache.erase(selectionCache.begin(), evicted);
+}
+
 void TraceDataProxy::updateSelection() {
-    delete selection;
-    auto subtrace = trace->subtrace(begin, end);
-    selection = UITrace::forResolution(subtrace, subtrace->getRuntime() / 1920);
-    Q_EMIT selectionChanged(begin, end);
+    ++generation;
+    cancelPrefetch();
+
+    // Cached selections are shown right away and become the most recently used
+    auto key = selectionKey();
+    auto cached = std::find_if(selectionCache.rbegin(), selectionCache.rend(), [&key](const CachedSelection &entry) {
+        return entry.key.serves(key);
+    });
+    if (cached != selectionCache.rend()) {
+        std::rotate(std::prev(cached.base()), cached.base(), selectionCache.end());
+        shownGeneration = generation;
+        showSelection(selectionCache.back());
+        return;
+    }
+
+    if (!computingSelection) {
+        computeSelection();
+    }
 }
 
-void TraceDataProxy::setSelection(types::TraceTime newBegin, types::TraceTime newEnd) {
+TraceDataProxy::CachedSelection
+TraceDataProxy::compute(const std::shared_ptr<FileTrace> &source, const SelectionKey &key,
+                        const std::unordered_set<otf2::definition::location_group *> &locationGroups,
+                        const std::vector<std::size_t> &nodes, const std::vector<bool> *regions,
+                        const std::shared_ptr<Trace> &base, const std::function<bool()> &cancelled) {
+    // A cancelled computation returns an empty selection at the next step
+    auto stop = [&cancelled] { return cancelled && cancelled(); };
+    if (stop()) {
+        return {};
+    }
+
+    std::shared_ptr<Trace> newSelection;
+    auto timePerPixel = (key.end - key.begin) / key.resolution;
+    if (auto previous = dynamic_cast<const UITrace *>(base.get())) {
+        newSelection.reset(UITrace::forPan(previous, source.get(), key.begin, key.end, timePerPixel, &locationGroups,
+                                           regions));
+    }
+    if (!newSelection) {
+        newSelection.reset(UITrace::forWindow(source.get(), key.begin, key.end, timePerPixel, &locationGroups, regions));
+    }
+
+    // The first aggregate requested sweeps all slots of the trace, so nodes are only passed on the worker threads
+    auto aggregates = std::make_shared<std::map<std::size_t, SlotStore>>();
+    if (auto tree = source->getSystemTree()) {
+        for (auto node: nodes) {
+            if (stop()) {
+                return {};
+            }
+            aggregates->emplace(node, tree->aggregatedSlots(node, key.begin, key.end, source->getDefinitions()));
+        }
+    }
+
+    auto bytes = estimatedBytes(newSelection.get(), *aggregates);
+    return {key, newSelection, source, aggregates, bytes};
+}
+
+std::shared_ptr<Trace> TraceDataProxy::panBase(const SelectionKey &key) const {
+    // The most recently used selection the window was panned from
+    for (auto entry = selectionCache.rbegin(); entry != selectionCache.rend(); ++entry) {
+        if (entry->source == trace && key.pans(entry->key)) {
+            return entry->selection;
+        }
+    }
+    return nullptr;
+}
+
+void TraceDataProxy::computeSelection() {
+    computingSelection = true;
+
+    auto requestedGeneration = generation;
+    auto source = trace;
+    auto key = selectionKey();
+    auto regions = regionMask;
+    auto locationGroups = visibleLocationGroups();
+    auto nodes = visibleNodes();
+    auto base = panBase(key);
+
+    // Splicing a pan is cheap, other windows are shown coarse first if the last one did not fit into a frame
+    auto coarseKey = key;
+    coarseKey.resolution = key.resolution / layout::COARSE_RESOLUTION_DIVISOR;
+    auto coarse = !base && computeTime > layout::FRAME_BUDGET_MS && coarseKey.resolution > 0;
+    selectionPool.start([this, requestedGeneration, source, key, coarseKey, coarse, regions, locationGroups, nodes,
+                         base] {
+        if (coarse) {
+            auto computed = compute(source, coarseKey, locationGroups, nodes, regions.get());
+            QMetaObject::invokeMethod(this, [this, requestedGeneration, computed] {
+                coarseSelectionComputed(requestedGeneration, computed);
+            }, Qt::QueuedConnection);
+        }
+
+        // The refinement is no longer requested, continue with the latest window right away
+        if (generation != requestedGeneration) {
+            QMetaObject::invokeMethod(this, [this, requestedGeneration] {
+                selectionComputed(requestedGeneration, CachedSelection(), -1);
+            }, Qt::QueuedConnection);
+            return;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        auto computed = compute(source, key, locationGroups, nodes, regions.get(), base);
+        auto elapsed = base ? -1 : timer.elapsed();
+        QMetaObject::invokeMethod(this, [this, requestedGeneration, computed, elapsed] {
+            selectionComputed(requestedGeneration, computed, elapsed);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TraceDataProxy::schedulePrefetch() {
+    prefetchTimer.start();
+}
+
+void TraceDataProxy::cancelPrefetch() {
+    prefetchTimer.stop();
+    prefetchPool.clear();
+    ++prefetchGeneration;
+}
+
+void TraceDataProxy::prefetch() {
+    // The windows of a single wheel step, as requested by TimelineView::wheelEvent()
+    const std::pair<types::TraceTime, types::TraceTime> windows[] = {
+        zoomedWindow(1, zoomOrigin), zoomedWindow(-1, zoomOrigin), pannedWindow(1), pannedWindow(-1)
+    };
+
+    auto epoch = cacheEpoch;
+    std::uint64_t requestedGeneration = prefetchGeneration;
+    auto source = trace;
+    auto regions = regionMask;
+    auto locationGroups = visibleLocationGroups();
+    auto nodes = visibleNodes();
+    for (const auto &[from, to]: windows) {
+        auto key = selectionKey();
+        key.begin = from;
+        key.end = to;
+        auto cached = std::any_of(selectionCache.begin(), selectionCache.end(), [&key](const CachedSelection &entry) {
+            return entry.key.serves(key);
+        });
+        if (to <= from || cached) {
+            continue;
+        }
+
+        auto base = panBase(key);
+        prefetchPool.start([this, epoch, requestedGeneration, source, key, regions, locationGroups, nodes, base] {
+            auto computed = compute(source, key, locationGroups, nodes, regions.get(), base, [this, requestedGeneration] {
+                return prefetchGeneration != requestedGeneration;
+            });
+            if (!computed.selection) {
+                return;
+            }
+            QMetaObject::invokeMethod(this, [this, epoch, computed] {
+                // The rows or the trace changed since, the key no longer describes the selection
+                if (epoch == cacheEpoch) {
+                    cacheSelection(computed);
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void TraceDataProxy::coarseSelectionComputed(std::uint64_t requestedGeneration, const CachedSelection &computed) {
+    if (requestedGeneration == generation) {
+        showSelection(computed, false);
+    }
+}
+
+void TraceDataProxy::selectionComputed(std::uint64_t requestedGeneration, const CachedSelection &computed,
+                                       qint64 elapsed) {
+    computingSelection = false;
+    if (elapsed >= 0) {
+        computeTime = elapsed;
+    }
+
+    // The window changed while computing, skip this result and continue with the latest window unless it was cached
+    if (requestedGeneration != generation) {
+        if (shownGeneration != generation) {
+            computeSelection();
+        }
+        return;
+    }
+
+    cacheSelection(computed);
+    shownGeneration = generation;
+    showSelection(computed);
+}
+
+void TraceDataProxy::showSelection(const CachedSelection &computed, bool refined) {
+    auto panned = computed.source == selectionTrace && computed.key.pans(selectionShown);
+    pannedFrom = panned ? selection : nullptr;
+
+    selection = computed.selection;
+    selectionAggregates = computed.aggregates;
+    selectionTrace = computed.source;
+    selectionShown = computed.key;
+    Q_EMIT selectionChanged(computed.key.begin, computed.key.end);
+
+    // Prefetching would compete with the refinement of a coarse selection
+    if (refined) {
+        schedulePrefetch();
+    }
+}
+
+std::pair<types::TraceTime, types::TraceTime> TraceDataProxy::clampWindow(types::TraceTime newBegin,
+                                                                          types::TraceTime newEnd) const {
     newBegin = qMax(types::TraceTime(0), newBegin);
     newEnd = qMin(getTotalRuntime(), newEnd);
 
     newBegin = qMin(newEnd, newBegin);
     newEnd = qMax(newBegin, newEnd);
+    return {newBegin, newEnd};
+}
+
+std::pair<types::TraceTime, types::TraceTime> TraceDataProxy::zoomedWindow(int steps, double origin) const {
+    auto runtime = end - begin;
+    auto delta = static_cast<double>((runtime / settings->getZoomQuotient() * steps).count());
+
+    // The time under the origin stays in place
+    auto leftDelta = types::TraceTime(static_cast<long>(origin * 2 * delta));
+    auto rightDelta = types::TraceTime(static_cast<long>((1 - origin) * 2 * delta));
+    return clampWindow(begin + leftDelta, begin + runtime - rightDelta);
+}
+
+std::pair<types::TraceTime, types::TraceTime> TraceDataProxy::pannedWindow(int steps) const {
+    auto runtime = end - begin;
+    auto deltaDuration = runtime / settings->getZoomQuotient() * steps;
 
+    // Panning by whole pixels lets views move what they rendered instead of rendering it again
+    if (runtime.count() > 0) {
+        auto resolution = static_cast<double>(getResolution());
+        auto pixels = std::round(static_cast<double>(deltaDuration.count()) * resolution / static_cast<double>(runtime.count()));
+        deltaDuration = types::TraceTime(static_cast<long>(pixels * static_cast<double>(runtime.count()) / resolution));
+    }
+
+    // Calculate new absolute times (might be negative or to large)
+    auto newBeginAbs = begin - deltaDuration;
+    auto newEndAbs = begin + runtime - deltaDuration;
+
+    // Limit the times to their boundaries (0 for start and end of entire trace for end)
+    auto newBeginBounded = qMax(newBeginAbs, types::TraceTime(0));
+    auto newEndBounded = qMin(newEndAbs, getTotalRuntime());
+
+    // If one time exceeds the bounds reject the changes
+    return clampWindow(qMin(newBeginBounded, newEndBounded - runtime), qMax(newEndBounded, newBeginBounded + runtime));
+}
+
+void TraceDataProxy::setZoomOrigin(double origin) {
+    if (origin == zoomOrigin) {
+        return;
+    }
+
+    // Prefetched zoomed windows depend on the origin, so prefetching starts over once the mouse rests
+    zoomOrigin = origin;
+    cancelPrefetch();
+    if (!computingSelection) {
+        schedulePrefetch();
+    }
+}
+
+void TraceDataProxy::setSelection(types::TraceTime newBegin, types::TraceTime newEnd) {
+    std::tie(newBegin, newEnd) = clampWindow(newBegin, newEnd);
+
+    if (newBegin != begin || newEnd != end) {
+        recordHistory();
+    }
+    applyWindow(newBegin, newEnd);
+}
+
+void TraceDataProxy::zoomBack() {
+    if (backHistory.empty()) {
+        return;
+    }
+
+    forwardHistory.emplace_back(begin, end);
+    auto [newBegin, newEnd] = backHistory.back();
+    backHistory.pop_back();
+
+    // The next change of the window is recorded even if it follows right away
+    historyTimer.invalidate();
+    Q_EMIT historyChanged(canZoomBack(), canZoomForward());
+    applyWindow(qMin(newBegin, getTotalRuntime()), qMin(newEnd, getTotalRuntime()));
+}
+
+void TraceDataProxy::zoomForward() {
+    if (forwardHistory.empty()) {
+        return;
+    }
+
+    backHistory.emplace_back(begin, end);
+    auto [newBegin, newEnd] = forwardHistory.back();
+    forwardHistory.pop_back();
+
+    historyTimer.invalidate();
+    Q_EMIT historyChanged(canZoomBack(), canZoomForward());
+    applyWindow(qMin(newBegin, getTotalRuntime()), qMin(newEnd, getTotalRuntime()));
+}
+
+void TraceDataProxy::recordHistory() {
+    // Steps of a continuous zoom or pan, e.g. turning the mouse wheel, only record the window they started from
+    if (!historyTimer.isValid() || historyTimer.elapsed() >= layout::HISTORY_COALESCE_MS) {
+        backHistory.emplace_back(begin, end);
+        if (backHistory.size() > layout::MAX_HISTORY) {
+            backHistory.erase(backHistory.begin());
+        }
+    }
+    historyTimer.start();
+    forwardHistory.clear();
+    Q_EMIT historyChanged(canZoomBack(), canZoomForward());
+}
+
+void TraceDataProxy::applyWindow(types::TraceTime newBegin, types::TraceTime newEnd) {
     auto oldBegin = begin;
     auto oldEnd = end;
 
@@ -92,16 +655,73 @@ void TraceDataProxy::setSelection(types::TraceTime newBegin, types::TraceTime ne
     }
 }
 
+void TraceDataProxy::setVisibleRows(std::size_t first, std::size_t end) {
+    if (first >= firstRow && end <= endRow) {
+        return;
+    }
+
+    firstRow = first > layout::ROW_MARGIN ? first - layout::ROW_MARGIN : 0;
+    endRow = end + layout::ROW_MARGIN;
+    updateSelection();
+}
+
 void TraceDataProxy::setTimeElementSelection(TimedElement *newSlot) {
+    if (auto slot = dynamic_cast<Slot *>(newSlot)) {
+        selectedSlot = std::make_unique<Slot>(*slot);
+        newSlot = selectedSlot.get();
+    }
+    infoElement = newSlot;
     Q_EMIT infoElementSelected(newSlot);
 }
 
 void TraceDataProxy::setFilter(Filter filter) {
     settings->setFilter(filter);
+    updateRegionMask();
 
     Q_EMIT filterChanged(filter);
+    updateSelection();
 }
 
 Trace *TraceDataProxy::getFullTrace() const {
-    return trace;
+    return trace.get();
+}
+
+void TraceDataProxy::setFullTrace(FileTrace *newTrace) {
+    auto oldTrace = trace.get();
+    auto entireTraceSelected = begin == types::TraceTime(0) && end == oldTrace->getRuntime();
+
+    // The old trace is kept alive by the current selection until the selection of the new trace is computed
+    trace.reset(newTrace);
+
+    // Filtered traces keep the location groups and thereby the system tree, so the expansion state carries over
+    auto newTree = trace->getSystemTree();
+    if (!newTree || newTree->nodes().size() != expanded.size()) {
+        initRows();
+    } else {
+        updateRows();
+    }
+    Q_EMIT traceChanged();
+    Q_EMIT rowsChanged();
+
+    // Communications of the old trace are about to be deleted and selected slots may refer to its definitions, so the
+    // information dock shows the new trace instead
+    infoElement = trace.get();
+    Q_EMIT infoElementSelected(trace.get());
+    selectedSlot.reset();
+
+    auto newEnd = entireTraceSelected ? trace->getRuntime() : qMin(end, trace->getRuntime());
+    auto newBegin = qMin(begin, newEnd);
+    if (newBegin != begin) {
+        begin = newBegin;
+        Q_EMIT beginChanged(begin);
+    }
+    if (newEnd != end) {
+        end = newEnd;
+        Q_EMIT endChanged(end);
+    }
+
+    // The selection is rebuilt even if its bounds did not change, it still refers to the old trace
+    updateRegionMask();
+    clearSelectionCache();
+    updateSelection();
 }
@@ -19,7 +19,19 @@
 #define MOTIV_TRACEDATAPROXY_HPP
 
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <QElapsedTimer>
 #include <QObject>
+#include <QThreadPool>
+#include <QTimer>
 
 #include "src/models/Filetrace.hpp"
 #include "src/models/ViewSettings.hpp"
@@ -31,10 +43,98 @@
  * TraceDataProxy acts as an intermediate class between the views and the data.
  * This class tracks all state changes related to the representation of the trace, e.g. selections
  * and emits a signal on changes.
+ *
+ * The selection is computed on a worker thread. Changes of the selected time window are applied immediately, but
+ * getSelection() returns the previously computed selection until the selection of the new window is ready. At most
+ * one selection is computed at a time, windows requested in the meantime are coalesced into the latest one.
+ *
+ * Only slots of the kinds shown by the filter are part of the selection, so hidden slots do not hide the visible ones
+ * they would be summarized with.
+ *
+ * The resolution of the selection is negotiated with the views showing it: every view reports the width it shows the
+ * selection in, in device pixels, see setResolution(). The selection is computed for the widest view, so no view shows
+ * slots summarized over more than a pixel.
+ *
+ * Computed selections are kept in a least recently used cache limited to layout::SELECTION_CACHE_BYTES, keyed by the
+ * window, the filter, the resolution and the rows they were computed for. Returning to a window, e.g. by zoomBack() and
+ * zoomForward() along the history of windows, shows the cached selection right away.
+ *
+ * Once a selection is shown and no input arrives for layout::PREFETCH_DELAY_MS, the selections of the windows one
+ * mouse wheel step away are computed in the background and cached: zooming in and out around the position of the mouse
+ * and panning left and right, see zoomedWindow() and pannedWindow(). Prefetching runs on a low priority thread of its
+ * own and its pending windows are dropped as soon as the window, the filter, the rows or the resolution change. The
+ * window being prefetched at that time is abandoned before its next step, the slots of a window are not interrupted.
+ *
+ * A selection of a window panned from a computed one, see pannedWindow(), is spliced from the overlap of the computed
+ * selection and the newly exposed part of the window, see UITrace::forPan().
+ *
+ * Selections that took longer than layout::FRAME_BUDGET_MS to compute are refined progressively: the worker first
+ * computes the window at a resolution reduced by layout::COARSE_RESOLUTION_DIVISOR and shows it, then computes it at
+ * the full resolution. The refinement is skipped as soon as the window, the filter, the rows or the resolution change,
+ * so continuous input shows coarse selections and the full one follows once the input rests. Coarse selections are
+ * not cached.
+ *
+ * The proxy also holds the rows shown by the timeline. Traces with few location groups show a row per location group.
+ * Larger traces are shown along the system tree: every node gets a row showing the aggregate of its location groups
+ * and can be expanded to show its children. The slots of the node rows are computed with the selection, so the
+ * aggregates of the system tree are never built on the GUI thread, see getAggregatedSlots().
  */
 class TraceDataProxy : public QObject {
     Q_OBJECT
 
+public: // types
+    /**
+     * @brief A row of the timeline
+     */
+    struct Row {
+        otf2::definition::location_group *locationGroup = nullptr; /**< Location group of the row, nullptr for nodes */
+        std::size_t node = SystemTree::NO_NODE; /**< System tree node of a node row */
+        std::size_t depth = 0; /**< Indentation of the row */
+    };
+
+private: // types
+    /**
+     * @brief What a selection was computed for
+     */
+    struct SelectionKey {
+        types::TraceTime begin{0};
+        types::TraceTime end{0};
+        SlotKind kinds = None;
+        int resolution = 0;
+        std::size_t firstRow = 0;
+        std::size_t endRow = 0;
+
+        /**
+         * Whether a selection computed for this key can be shown for the requested key. Selections of at most twice the
+         * requested resolution or of more rows are used, they only have more detail than necessary.
+         */
+        [[nodiscard]] bool serves(const SelectionKey &request) const {
+            return begin == request.begin && end == request.end && kinds == request.kinds &&
+                   resolution >= request.resolution && resolution <= 2 * request.resolution &&
+                   firstRow <= request.firstRow && endRow >= request.endRow;
+        }
+
+        /**
+         * Whether this key only differs from another one by moving the window, which still overlaps the other window
+         */
+        [[nodiscard]] bool pans(const SelectionKey &other) const {
+            return kinds == other.kinds && resolution == other.resolution && firstRow == other.firstRow &&
+                   endRow == other.endRow && end - begin == other.end - other.begin && begin != other.begin &&
+                   begin < other.end && other.begin < end;
+        }
+    };
+
+    /**
+     * @brief A computed selection and the trace it refers to
+     */
+    struct CachedSelection {
+        SelectionKey key;
+        std::shared_ptr<Trace> selection;
+        std::shared_ptr<FileTrace> source;
+        std::shared_ptr<const std::map<std::size_t, SlotStore>> aggregates; /**< Slots of the node rows by node */
+        std::size_t bytes = 0; /**< Estimated memory used by the selection */
+    };
+
 public: //constructors
     /**
      * @brief Constructs a new TraceDataProxy.
@@ -52,7 +152,8 @@ public: // methods
     /**
      * @brief Returns the current selection
      *
-     * The selection refers to the parts of the trace that is in the selected time window
+     * The selection refers to the parts of the trace that is in the selected time window. While the selection of a
+     * new window is computed, the selection of the previous window is returned.
      *
      * @return The current selection
      */
@@ -87,9 +188,95 @@ public: // methods
      */
     [[nodiscard]] types::TraceTime getTotalRuntime() const;
 
+    /**
+     * @brief Returns the rows of the timeline from top to bottom
+     * @return The rows
+     */
+    [[nodiscard]] const std::vector<Row> &getRows() const;
+
+    /**
+     * @brief Returns the row showing a location group
+     *
+     * @param locationGroup Reference of the location group
+     * @return Index of the row of the location group or of the collapsed node containing it, the number of rows if the
+     * location group is unknown
+     */
+    [[nodiscard]] std::size_t getRowOf(otf2::reference<otf2::definition::location_group> locationGroup) const;
+
+    /**
+     * @brief Returns the system tree of the entire trace
+     * @return The system tree, nullptr if the trace has none
+     */
+    [[nodiscard]] const SystemTree *getSystemTree() const;
+
+    /**
+     * @brief Returns the dominant regions of a node in the window of the current selection
+     *
+     * Like the slots of the location groups, they are only computed for the visible rows and the rows around them.
+     *
+     * @param node Index of the system tree node
+     * @return The slots of the dominant regions, nullptr if the current selection has none for the node
+     */
+    [[nodiscard]] const SlotStore *getAggregatedSlots(std::size_t node) const;
+
+    /**
+     * @brief Returns whether a node of the system tree is expanded
+     * @param node Index of the node
+     * @return True if the children of the node are shown
+     */
+    [[nodiscard]] bool isExpanded(std::size_t node) const;
+
+    /**
+     * @brief Returns whether there is a window to go back to
+     * @return True if zoomBack() changes the window
+     */
+    [[nodiscard]] bool canZoomBack() const;
+
+    /**
+     * @brief Returns whether there is a window to go forward to
+     * @return True if zoomForward() changes the window
+     */
+    [[nodiscard]] bool canZoomForward() const;
+
+    /**
+     * @brief Returns the selection shown before the current one if the current one only moved its window
+     *
+     * Both selections were computed for the same filter, resolution and rows of the same trace and their windows have
+     * the same duration and overlap. Views can move what they rendered for the previous selection instead of rendering
+     * the overlap again.
+     *
+     * @return The previous selection, nullptr if the current selection is not a pan of it
+     */
+    [[nodiscard]] const Trace *getPannedFrom() const;
+
+    /**
+     * @brief Returns the window shown after zooming by mouse wheel steps
+     *
+     * @param steps Number of steps, positive to zoom in
+     * @param origin Position of the mouse relative to the width of the view, the time under it stays in place
+     * @return Begin and end of the zoomed window, limited to the trace
+     */
+    [[nodiscard]] std::pair<types::TraceTime, types::TraceTime> zoomedWindow(int steps, double origin) const;
+
+    /**
+     * @brief Returns the window shown after panning by mouse wheel steps
+     *
+     * The duration of the window is kept, windows reaching over the bounds of the trace are not moved.
+     *
+     * @param steps Number of steps, positive to pan towards the begin
+     * @return Begin and end of the panned window
+     */
+    [[nodiscard]] std::pair<types::TraceTime, types::TraceTime> pannedWindow(int steps) const;
+
+    /**
+     * @brief Returns the horizontal resolution the selection is computed for
+     * @return The width of the widest view in device pixels, layout::DEFAULT_RESOLUTION if no view reported its width
+     */
+    [[nodiscard]] int getResolution() const;
+
 public: Q_SIGNALS:
     /**
-     * Signals the selection has been changed
+     * Signals the selection has been computed for a new window
      */
     void selectionChanged(types::TraceTime newBegin, types::TraceTime newEnd);
     /**
@@ -106,7 +293,7 @@ public: Q_SIGNALS:
     void infoElementSelected(TimedElement *);
 
      /**
-     * Signals that the color of a slot has changed
+     * Signals that the color of a region has changed, views only have to repaint
      */
     void colorChanged();
 
@@ -115,6 +302,21 @@ public: Q_SIGNALS:
      */
     void filterChanged(Filter);
 
+    /**
+     * Signals the entire trace was replaced, e.g. by a more complete one while the trace is loaded
+     */
+    void traceChanged();
+
+    /**
+     * Signals the rows of the timeline changed, e.g. a node was expanded
+     */
+    void rowsChanged();
+
+    /**
+     * Signals the history of windows changed
+     */
+    void historyChanged(bool canZoomBack, bool canZoomForward);
+
 public Q_SLOTS:
     /**
      * Change the start time of the selection
@@ -137,6 +339,51 @@ public Q_SLOTS:
      */
     void setSelection(types::TraceTime newBegin, types::TraceTime newEnd);
 
+    /**
+     * Go back to the window shown before the current one
+     *
+     * Windows changed in quick succession, e.g. while turning the mouse wheel, are recorded as a single step.
+     */
+    void zoomBack();
+
+    /**
+     * Go forward to the window left by zoomBack()
+     */
+    void zoomForward();
+
+    /**
+     * Change the rows of location groups visible in the views
+     *
+     * Only the slots of the visible rows and of layout::ROW_MARGIN rows around them are part of the selection. The
+     * selection is recomputed once the visible rows leave the rows requested before.
+     * @param first index of the first visible row
+     * @param end index past the last visible row
+     */
+    void setVisibleRows(std::size_t first, std::size_t end);
+
+    /**
+     * Change the horizontal resolution a view shows the selection in
+     *
+     * The selection is recomputed if the widest view changes. Views are forgotten when they are destroyed.
+     * @param view the view showing the selection
+     * @param pixels width of the view in device pixels, 0 if the view no longer shows the selection
+     */
+    void setResolution(QObject *view, int pixels);
+
+    /**
+     * Change the position zooming is expected to be centered around, i.e. the position of the mouse over a view
+     *
+     * Only used to prefetch the selections of zoomed windows.
+     * @param origin position relative to the width of the view
+     */
+    void setZoomOrigin(double origin);
+
+    /**
+     * Expands a collapsed or collapses an expanded node row, other rows are ignored
+     * @param row index of the row
+     */
+    void toggleRow(std::size_t row);
+
     /**
      * Change the filter
      * @param filter
@@ -145,21 +392,157 @@ public Q_SLOTS:
 
     /**
      * Change the selected slot
+     *
+     * Slots are materialized from the slot stores of the trace, the proxy keeps a copy of a selected slot as long
+     * as it is selected.
      * @param newSlot pass nullptr if none selected
      */
     void setTimeElementSelection(TimedElement *newSlot);
 
+    /**
+     * Replace the entire trace
+     *
+     * Used to display a trace while it is loaded. If the entire old trace was selected, the entire new trace is
+     * selected, otherwise the selection is kept as far as possible. The object takes ownership of the new trace.
+     * @param newTrace The new trace
+     */
+    void setFullTrace(FileTrace *newTrace);
+
 private: // methods
+    void initRows();
+    void updateRows();
+    [[nodiscard]] std::unordered_set<otf2::definition::location_group *> visibleLocationGroups() const;
+    [[nodiscard]] std::vector<std::size_t> visibleNodes() const;
+
+    [[nodiscard]] SelectionKey selectionKey() const;
+    void updateRegionMask();
+    void clearSelectionCache();
+    void cacheSelection(const CachedSelection &computed);
+    void recordHistory();
+    void applyWindow(types::TraceTime newBegin, types::TraceTime newEnd);
+    [[nodiscard]] std::pair<types::TraceTime, types::TraceTime> clampWindow(types::TraceTime newBegin,
+                                                                            types::TraceTime newEnd) const;
+
+    void schedulePrefetch();
+    void cancelPrefetch();
+    void prefetch();
+
+    static CachedSelection compute(const std::shared_ptr<FileTrace> &source, const SelectionKey &key,
+                                   const std::unordered_set<otf2::definition::location_group *> &locationGroups,
+                                   const std::vector<std::size_t> &nodes, const std::vector<bool> *regions,
+                                   const std::shared_ptr<Trace> &base = nullptr,
+                                   const std::function<bool()> &cancelled = nullptr);
+    [[nodiscard]] std::shared_ptr<Trace> panBase(const SelectionKey &key) const;
     void updateSelection();
+    void computeSelection();
+    void coarseSelectionComputed(std::uint64_t requestedGeneration, const CachedSelection &computed);
+    void selectionComputed(std::uint64_t requestedGeneration, const CachedSelection &computed, qint64 elapsed);
+    void showSelection(const CachedSelection &computed, bool refined = true);
     void updateSlotSelection();
 
 private: // data
-    FileTrace *trace = nullptr;
-    Trace *selection = nullptr;
+    std::shared_ptr<FileTrace> trace;
+    std::shared_ptr<Trace> selection;
+    std::shared_ptr<const std::map<std::size_t, SlotStore>> selectionAggregates;
+
+    /**
+     * Trace the current selection was computed from, it refers to the elements of the trace
+     */
+    std::shared_ptr<FileTrace> selectionTrace;
+
+    /**
+     * Key of the current selection
+     */
+    SelectionKey selectionShown;
+
+    /**
+     * Selection shown before the current one if the current one is a pan of it, see getPannedFrom()
+     */
+    std::shared_ptr<Trace> pannedFrom;
+
+    /**
+     * Incremented whenever the selection has to be recomputed, results of older generations are dropped. The worker
+     * reads it to abort refining a selection that is no longer requested.
+     */
+    std::atomic<std::uint64_t> generation = 0;
+
+    /**
+     * Generation of the shown selection, the selection is up to date if it equals generation
+     */
+    std::uint64_t shownGeneration = 0;
+
+    /**
+     * Computed selections from least to most recently used, valid for the current layout of rows and trace
+     */
+    std::vector<CachedSelection> selectionCache;
+    std::size_t selectionCacheBytes = 0;
+
+    /**
+     * Incremented whenever the cache is cleared, prefetched selections of older epochs are dropped
+     */
+    std::uint64_t cacheEpoch = 0;
+
+    QThreadPool prefetchPool;
+    QTimer prefetchTimer;
+
+    /**
+     * Incremented whenever prefetching is cancelled. A running prefetch reads it to stop before its next step, e.g.
+     * between the aggregates of two nodes.
+     */
+    std::atomic<std::uint64_t> prefetchGeneration = 0;
+    double zoomOrigin = 0.5;
+
+    /**
+     * Windows to go back and forward to, the most recent ones at the end
+     */
+    std::vector<std::pair<types::TraceTime, types::TraceTime>> backHistory;
+    std::vector<std::pair<types::TraceTime, types::TraceTime>> forwardHistory;
+
+    /**
+     * Time since the window was last changed by setSelection()
+     */
+    QElapsedTimer historyTimer;
+
+    /**
+     * Regions of the kinds shown by the filter, see DefinitionRegistry::regionMask(), nullptr to show all regions
+     */
+    std::shared_ptr<const std::vector<bool>> regionMask;
+
+    /**
+     * Widths in device pixels of the views showing the selection
+     */
+    std::unordered_map<QObject *, int> resolutions;
+
+    /**
+     * Rows [firstRow, endRow) whose slots are computed
+     */
+    std::size_t firstRow = 0;
+    std::size_t endRow = 0;
+
+    std::vector<Row> rows;
+    std::vector<bool> expanded;
+
+    /**
+     * Rows by the reference of the location group they show
+     */
+    std::unordered_map<std::uint64_t, std::size_t> rowIndices;
+    bool computingSelection = false;
+
+    /**
+     * Milliseconds it took to compute the last selection that was not spliced from a panned one, -1 if unknown
+     */
+    qint64 computeTime = -1;
+    QThreadPool selectionPool;
     ViewSettings *settings = nullptr;
+    std::unique_ptr<Slot> selectedSlot;
 
     types::TraceTime begin{0};
     types::TraceTime end{0};
+
+    /**
+     * Element last shown in the information dock
+     */
+    TimedElement *infoElement = nullptr;
 };
 
 
@@ -0,0 +1,118 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RowRasterizer.hpp"
+#include "src/ui/Constants.hpp"
+
+#include <cmath>
+#include <map>
+
+RowRasterizer::RowRasterizer(const Trace *trace, types::TraceTime begin, types::TraceTime runtime, qreal width,
+                             SlotKind kinds)
+    : begin_(begin), runtime_(qMax(runtime, types::TraceTime(1))), width_(width), kinds_(kinds) {
+    for (const auto &[locationGroup, slots]: trace->getSlots()) {
+        if ((definitions_ = slots.definitions())) {
+            break;
+        }
+    }
+    if (!definitions_) {
+        return;
+    }
+
+    for (auto region: definitions_->regions()) {
+        auto ref = region->ref().get();
+        if (ref >= styles_.size()) {
+            styles_.resize(ref + 1);
+        }
+        const auto &attributes = definitions_->regionAttributes(ref);
+        styles_[ref] = {attributes.paletteIndex, attributes.priority, attributes.kind};
+    }
+}
+
+qreal RowRasterizer::toX(types::TraceTime time) const {
+    return static_cast<qreal>((time - begin_).count()) / static_cast<qreal>(runtime_.count()) * width_;
+}
+
+types::TraceTime RowRasterizer::toTime(qreal x) const {
+    if (width_ <= 0) {
+        return begin_;
+    }
+    return begin_ + types::TraceTime(std::llround(x / width_ * static_cast<qreal>(runtime_.count())));
+}
+
+const RowRasterizer::RegionStyle &RowRasterizer::style(const SlotStore &slots, std::size_t i) const {
+    static const RegionStyle unknown{NO_PALETTE_INDEX, Slot::priorityOf(Plain), Plain};
+
+    auto ref = slots.regionIndex(i);
+    return ref < styles_.size() && styles_[ref].kind != None ? styles_[ref] : unknown;
+}
+
+QRgb RowRasterizer::color(std::uint32_t paletteIndex) const {
+    if (paletteIndex == NO_PALETTE_INDEX) {
+        return colors::COLOR_SLOT_PLAIN.rgba();
+    }
+    return definitions_->paletteColor(paletteIndex);
+}
+
+QRectF RowRasterizer::slotRect(const SlotStore &slots, std::size_t i, qreal top, qreal height) const {
+    // Ensures slots starting before `begin` (like main) are considered to start at begin
+    auto effectiveStartTime = qMax(begin_, slots.start(i));
+    // Ensures slots ending after `end` (like main) are considered to end at end
+    auto effectiveEndTime = qMin(begin_ + runtime_, slots.end(i));
+
+    auto x = toX(effectiveStartTime);
+    auto rectWidth = toX(effectiveEndTime) - x;
+    return {x, top, qMax(rectWidth, layout::MIN_SLOT_WIDTH), height};
+}
+
+void RowRasterizer::paintRow(QPainter &painter, const SlotStore &slots, qreal top, qreal height,
+                             const QRectF &area) const {
+    std::map<std::pair<int, std::uint32_t>, std::vector<QRectF>> batches;
+
+    // Slots shorter than a few pixels are widened to MIN_SLOT_WIDTH and may reach into the area from the left
+    auto from = toTime(area.left() - layout::MIN_SLOT_WIDTH);
+    auto to = toTime(area.right() + 1);
+    slots.forEachOverlapping(from, to, [&](std::size_t i) {
+        const auto &slotStyle = style(slots, i);
+        if (!(slotStyle.kind & kinds_)) return;
+
+        auto rect = slotRect(slots, i, top, height);
+        if (!rect.intersects(area)) return;
+
+        batches[{slotStyle.priority, slotStyle.paletteIndex}].push_back(rect);
+    });
+
+    for (const auto &[key, rects]: batches) {
+        painter.setBrush(QColor::fromRgba(color(key.second)));
+        painter.drawRects(rects.data(), static_cast<int>(rects.size()));
+    }
+}
+
+std::optional<std::size_t> RowRasterizer::slotAt(const SlotStore &slots, QPointF point, qreal top, qreal height) const {
+    std::optional<std::size_t> found;
+    auto bestPriority = -1;
+    slots.forEachOverlapping(toTime(point.x() - layout::MIN_SLOT_WIDTH), toTime(point.x() + 1), [&](std::size_t i) {
+        const auto &slotStyle = style(slots, i);
+        if (!(slotStyle.kind & kinds_)) return;
+
+        if (slotStyle.priority >= bestPriority && slotRect(slots, i, top, height).contains(point)) {
+            bestPriority = slotStyle.priority;
+            found = i;
+        }
+    });
+    return found;
+}
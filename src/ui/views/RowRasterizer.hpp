@@ -0,0 +1,154 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_ROWRASTERIZER_HPP
+#define MOTIV_ROWRASTERIZER_HPP
+
+
+#include <cstdint>
+#include <latch>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include <QPainter>
+#include <QThreadPool>
+
+#include "src/models/Trace.hpp"
+
+/**
+ * @brief Paints the slots of timeline rows
+ *
+ * A RowRasterizer maps a time window of a trace to a horizontal pixel range and paints the slots of single rows with
+ * batched rectangle fills. Priorities of all regions are resolved on construction, colors are looked up in the palette
+ * of the definition registry while painting. A changed color is therefore shown by the next paint without creating a
+ * new rasterizer. Painting only reads the slot stores, the resolved styles and the palette, rows can be rasterized from
+ * worker threads concurrently, each worker painting into its own image, see forEachParallel().
+ */
+class RowRasterizer {
+public:
+    /**
+     * @brief How the slots of a region are painted
+     */
+    struct RegionStyle {
+        std::uint32_t paletteIndex = NO_PALETTE_INDEX;
+        int priority = 0;
+        SlotKind kind = None;
+    };
+
+    /**
+     * @brief Palette index of regions not in the definition registry, they are painted in the plain slot color
+     */
+    static constexpr std::uint32_t NO_PALETTE_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+public: // constructors
+    RowRasterizer() = default;
+
+    /**
+     * @brief Creates a new instance of the RowRasterizer class
+     *
+     * @param trace The trace whose rows are painted
+     * @param begin The time shown at the left border
+     * @param runtime The duration of the shown time window
+     * @param width The width in pixels the time window is mapped to
+     * @param kinds The kinds of slots to paint
+     */
+    RowRasterizer(const Trace *trace, types::TraceTime begin, types::TraceTime runtime, qreal width, SlotKind kinds);
+
+public: // methods
+    /**
+     * @brief Returns the horizontal position of a point in time
+     */
+    [[nodiscard]] qreal toX(types::TraceTime time) const;
+
+    /**
+     * @brief Returns the point in time at a horizontal position
+     */
+    [[nodiscard]] types::TraceTime toTime(qreal x) const;
+
+    /**
+     * @brief Returns the style of the i-th slot of a slot store
+     */
+    [[nodiscard]] const RegionStyle &style(const SlotStore &slots, std::size_t i) const;
+
+    /**
+     * @brief Returns the current color of a palette index, see RegionStyle::paletteIndex
+     */
+    [[nodiscard]] QRgb color(std::uint32_t paletteIndex) const;
+
+    /**
+     * @brief Returns the rectangle the i-th slot of a slot store is painted in
+     *
+     * Slots are clipped to the time window and widened to layout::MIN_SLOT_WIDTH.
+     */
+    [[nodiscard]] QRectF slotRect(const SlotStore &slots, std::size_t i, qreal top, qreal height) const;
+
+    /**
+     * @brief Paints the slots of a row intersecting an area
+     *
+     * Slots are batched by priority and color, batches of higher priority are painted on top.
+     *
+     * @param painter The painter to paint with, its pen is used for the outlines of the slots
+     * @param slots The slots of the row
+     * @param top The upper border of the row
+     * @param height The height of the row
+     * @param area The area to paint, slots outside of it are skipped
+     */
+    void paintRow(QPainter &painter, const SlotStore &slots, qreal top, qreal height, const QRectF &area) const;
+
+    /**
+     * @brief Returns the topmost painted slot of a row at a point
+     */
+    [[nodiscard]] std::optional<std::size_t> slotAt(const SlotStore &slots, QPointF point, qreal top, qreal height) const;
+
+    /**
+     * @brief Calls a function for every index in [0, count) on the global thread pool and waits for all calls
+     *
+     * The calling thread takes part in the work.
+     */
+    template<typename F>
+    static void forEachParallel(std::size_t count, F fn) {
+        if (count == 0) {
+            return;
+        }
+
+        std::latch done(static_cast<std::ptrdiff_t>(count - 1));
+        for (std::size_t i = 1; i < count; ++i) {
+            QThreadPool::globalInstance()->start([&fn, &done, i] {
+                fn(i);
+                done.count_down();
+            });
+        }
+        fn(0);
+        done.wait();
+    }
+
+private:
+    types::TraceTime begin_{0};
+    types::TraceTime runtime_{1};
+    qreal width_ = 0;
+    SlotKind kinds_ = None;
+    const DefinitionRegistry *definitions_ = nullptr;
+
+    /**
+     * Styles of the regions indexed by their reference
+     */
+    std::vector<RegionStyle> styles_;
+};
+
+
+#endif //MOTIV_ROWRASTERIZER_HPP
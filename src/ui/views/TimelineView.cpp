@@ -16,190 +16,531 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TimelineView.hpp"
-#include "src/ui/views/CommunicationIndicator.hpp"
-#include "src/ui/views/SlotIndicator.hpp"
+#include "src/models/SystemTree.hpp"
 #include "src/ui/Constants.hpp"
-#include "CollectiveCommunicationIndicator.hpp"
-#include "src/ui/ColorGenerator.hpp"
 
-#include <QGraphicsRectItem>
+#include <cmath>
+
 #include <QApplication>
+#include <QHelpEvent>
+#include <QLineF>
+#include <QPainter>
+#include <QScrollBar>
+#include <QToolTip>
 #include <QWheelEvent>
 
-TimelineView::TimelineView(TraceDataProxy *data, QWidget *parent) : QGraphicsView(parent), data(data) {
-    auto scene = new QGraphicsScene();
-    this->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+namespace {
+    /**
+     * Maximum distance in pixels between the mouse and a communication arrow to hit the arrow
+     */
+    const qreal HIT_TOLERANCE = 3.0;
+
+    /**
+     * Number of strips kept in the cache before strips outside the viewport are dropped
+     */
+    const std::size_t MAX_CACHED_STRIPS = 128;
+
+    qreal distanceToLine(const QLineF &line, const QPointF &point) {
+        auto direction = line.p2() - line.p1();
+        auto lengthSquared = QPointF::dotProduct(direction, direction);
+        if (lengthSquared == 0) {
+            return QLineF(line.p1(), point).length();
+        }
+        auto t = qBound(0.0, QPointF::dotProduct(point - line.p1(), direction) / lengthSquared, 1.0);
+        return QLineF(line.p1() + t * direction, point).length();
+    }
+}
+
+TimelineView::TimelineView(TraceDataProxy *data, QWidget *parent) : QAbstractScrollArea(parent), data(data) {
     this->setAutoFillBackground(false);
     this->setStyleSheet("background: transparent");
-    this->setScene(scene);
     this->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    
+    this->viewport()->setAutoFillBackground(false);
+    this->viewport()->setMouseTracking(true);
+
     // @formatter:off
     connect(this->data, SIGNAL(selectionChanged(types::TraceTime,types::TraceTime)), this, SLOT(updateView()));
     connect(this->data, SIGNAL(filterChanged(Filter)), this, SLOT(updateView()));
-    connect(this->data, SIGNAL(colorChanged()),this, SLOT(updateView()));
+    connect(this->data, SIGNAL(colorChanged()),this, SLOT(updateColors()));
+    connect(this->data, SIGNAL(rowsChanged()), this, SLOT(updateView()));
     // @formatter:on
+
+    updateView();
+}
+
+void TimelineView::updateView() {
+    // Strips rendered for the selection the current one was panned from are moved instead of rendered again. The
+    // previous selection may already be deleted, it is only compared to the one the proxy keeps alive.
+    auto previous = selection;
+    auto previousBegin = selectionBegin;
+    auto previousWidth = width;
+
+    this->updateGeometry();
+    auto panned = previous && previous == data->getPannedFrom() && width == previousWidth;
+    if (!panned || !this->shiftStrips(previousBegin)) {
+        this->invalidateStrips();
+    }
+    this->updateScrollBars();
+    this->viewport()->update();
+}
+
+void TimelineView::updateColors() {
+    // Colors are looked up when painting, only the cached strips are outdated
+    this->invalidateStrips();
+    this->viewport()->update();
+}
+
+void TimelineView::updateGeometry() {
+    selection = data->getSelection();
+    // The selection may still show the previous window while the current one is computed
+    auto begin = selection->getStartTime();
+    auto runtime = qMax(selection->getRuntime(), types::TraceTime(1));
+    selectionBegin = begin;
+    width = static_cast<qreal>(viewport()->width());
+    rasterizer = RowRasterizer(selection, begin, runtime, width, data->getSettings()->getFilter().getSlotKinds());
+    hovered = Hit();
+
+    const auto &selectionSlots = selection->getSlots();
+
+    // Rows the selection was not computed for, e.g. after scrolling, stay empty until it is
+    rows.clear();
+    for (const auto &row: data->getRows()) {
+        if (row.node != SystemTree::NO_NODE) {
+            auto slots = data->getAggregatedSlots(row.node);
+            rows.push_back({nullptr, row.node, slots ? slots : &emptySlots});
+        } else {
+            auto it = selectionSlots.find(row.locationGroup);
+            rows.push_back({row.locationGroup, SystemTree::NO_NODE, it != selectionSlots.end() ? &it->second : &emptySlots});
+        }
+    }
+
+    auto beginR = static_cast<qreal>(begin.count());
+    auto endR = beginR + static_cast<qreal>(runtime.count());
+
+    arrows.clear();
+    for (const auto &communication: selection->getCommunications()) {
+        const CommunicationEvent *startEvent = communication->getStartEvent();
+        auto startEventEnd = static_cast<qreal>(startEvent->getEndTime().count());
+        auto startEventStart = static_cast<qreal>(startEvent->getStartTime().count());
+
+        const CommunicationEvent *endEvent = communication->getEndEvent();
+        auto endEventEnd = static_cast<qreal>(endEvent->getEndTime().count());
+        auto endEventStart = static_cast<qreal>(endEvent->getStartTime().count());
+
+        auto fromTime = startEventStart + (startEventEnd - startEventStart) / 2;
+        auto toTime = endEventStart + (endEventEnd - endEventStart) / 2;
+
+        // Ranks of collapsed nodes are drawn in the row of the node
+        auto fromRank = data->getRowOf(startEvent->getLocation()->location_group().ref());
+        auto toRank = data->getRowOf(endEvent->getLocation()->location_group().ref());
+        if (fromRank >= rows.size() || toRank >= rows.size()) {
+            continue;
+        }
+
+        QPointF from(rasterizer.toX(types::TraceTime(static_cast<long>(qMax(beginR, fromTime)))),
+                     static_cast<qreal>(fromRank * layout::ROW_HEIGHT) + .5 * layout::ROW_HEIGHT + layout::ROW_OFFSET);
+        QPointF to(rasterizer.toX(types::TraceTime(static_cast<long>(qMin(endR, toTime)))),
+                   static_cast<qreal>(toRank * layout::ROW_HEIGHT) + .5 * layout::ROW_HEIGHT + layout::ROW_OFFSET);
+
+        auto polygon = arrowPolygon(from, to);
+        auto bounds = polygon.boundingRect().adjusted(-HIT_TOLERANCE, -HIT_TOLERANCE, HIT_TOLERANCE, HIT_TOLERANCE);
+        arrows.push_back({communication, std::move(polygon), bounds});
+    }
+
+    collectives.clear();
+    auto collectivesBottom = layout::ROW_OFFSET + static_cast<int>(rows.size()) * layout::ROW_HEIGHT + layout::ROW_OFFSET / 2;
+    for (const auto &communication: selection->getCollectiveCommunications()) {
+        auto left = rasterizer.toX(qMax(begin, communication->getStartTime()));
+        auto right = rasterizer.toX(qMin(begin + runtime, communication->getEndTime()));
+        collectives.push_back({communication, QRectF(QPointF(left, layout::ROW_OFFSET / 2),
+                                                     QPointF(right, collectivesBottom))});
+    }
 }
 
+void TimelineView::updateScrollBars() {
+    auto scrollBar = verticalScrollBar();
+    scrollBar->setPageStep(viewport()->height());
+    scrollBar->setSingleStep(layout::ROW_HEIGHT);
+    scrollBar->setRange(0, qMax(0, contentHeight() - viewport()->height()));
+}
 
-void TimelineView::populateScene(QGraphicsScene *scene) {
-    auto width = scene->width();
-    auto selection = this->data->getSelection();
-    auto runtime = selection->getRuntime().count();
-    auto runtimeR = static_cast<qreal>(runtime);
-    auto begin = this->data->getBegin().count();
-    auto beginR = static_cast<qreal>(begin);
-    auto end = begin + runtime;
-    auto endR = static_cast<qreal>(end);
+void TimelineView::updateVisibleRows() {
+    auto offset = verticalScrollBar()->value();
+    auto first = qMax(0, (offset - layout::ROW_OFFSET) / layout::ROW_HEIGHT);
+    auto end = qMax(first, (offset + viewport()->height() - layout::ROW_OFFSET) / layout::ROW_HEIGHT + 1);
+    data->setVisibleRows(static_cast<std::size_t>(first), static_cast<std::size_t>(end));
+}
 
-    QPen arrowPen(Qt::black, 1);
-    QPen collectiveCommunicationPen(colors::COLOR_COLLECTIVE_COMMUNICATION, 2);
+void TimelineView::invalidateStrips() {
+    strips.clear();
+}
 
+bool TimelineView::shiftStrips(types::TraceTime previousBegin) {
+    // The previous content moves by whole device pixels, otherwise it is rendered again
+    auto pixelRatio = devicePixelRatioF();
+    auto exactOffset = rasterizer.toX(previousBegin) * pixelRatio;
+    auto offset = qRound(exactOffset);
+    auto stripWidth = viewport()->width();
+    if (std::abs(exactOffset - offset) > 0.01 || std::abs(offset) >= qRound(stripWidth * pixelRatio)) {
+        return false;
+    }
 
-    auto onTimedElementSelected = [this](TimedElement *element) { this->data->setTimeElementSelection(element); };
-    auto onTimedElementDoubleClicked = [this](TimedElement *element) {
-        this->data->setSelection(element->getStartTime(), element->getEndTime());
+    // Besides the exposed columns, slots next to the previous borders are clipped or widened differently
+    auto margin = layout::MIN_SLOT_WIDTH + 2;
+    auto shift = static_cast<qreal>(offset) / pixelRatio;
+    auto left = shift > 0 ? 0.0 : static_cast<qreal>(stripWidth) + shift - margin;
+    auto right = shift > 0 ? shift + margin : static_cast<qreal>(stripWidth);
+
+    std::vector<std::pair<const int, Strip> *> shifted;
+    for (auto &entry: strips) {
+        shifted.push_back(&entry);
+    }
+    RowRasterizer::forEachParallel(shifted.size(), [&](std::size_t i) {
+        auto &[index, strip] = *shifted[i];
+        QImage image(strip.slots.size(), QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(pixelRatio);
+        image.fill(Qt::transparent);
+        {
+            QPainter painter(&image);
+            painter.drawImage(QPointF(shift, 0), strip.slots);
+        }
+
+        QRect rect(0, index * layout::STRIP_HEIGHT, stripWidth, layout::STRIP_HEIGHT);
+        renderSlots(image, rect, QRectF(QPointF(left, rect.top()), QPointF(right, rect.top() + rect.height())));
+        strip.slots = std::move(image);
+        strip.overlay = QImage();
+    });
+    return true;
+}
+
+void TimelineView::renderStrips(int first, int last) {
+    std::vector<int> missing;
+    std::vector<int> missingOverlays;
+    for (auto strip = first; strip <= last; ++strip) {
+        auto it = strips.find(strip);
+        if (it == strips.end()) {
+            missing.push_back(strip);
+        } else if (it->second.overlay.isNull()) {
+            missingOverlays.push_back(strip);
+        }
+    }
+
+    auto pixelRatio = devicePixelRatioF();
+    auto stripWidth = viewport()->width();
+    auto newImage = [&] {
+        QImage image(QSize(stripWidth, layout::STRIP_HEIGHT) * pixelRatio, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(pixelRatio);
+        return image;
     };
 
+    // Strips moved by a pan only miss their communications
+    std::vector<Strip> rendered(missing.size());
+    std::vector<QImage> overlays(missingOverlays.size());
+    RowRasterizer::forEachParallel(missing.size() + missingOverlays.size(), [&](std::size_t i) {
+        if (i < missing.size()) {
+            QRect rect(0, missing[i] * layout::STRIP_HEIGHT, stripWidth, layout::STRIP_HEIGHT);
+            rendered[i].slots = newImage();
+            rendered[i].slots.fill(Qt::transparent);
+            renderSlots(rendered[i].slots, rect, QRectF(rect));
+            rendered[i].overlay = newImage();
+            renderOverlay(rendered[i].overlay, rect);
+        } else {
+            auto j = i - missing.size();
+            overlays[j] = newImage();
+            renderOverlay(overlays[j], QRect(0, missingOverlays[j] * layout::STRIP_HEIGHT, stripWidth,
+                                             layout::STRIP_HEIGHT));
+        }
+    });
+
+    for (std::size_t i = 0; i < missing.size(); ++i) {
+        strips.emplace(missing[i], std::move(rendered[i]));
+    }
+    for (std::size_t j = 0; j < missingOverlays.size(); ++j) {
+        strips.at(missingOverlays[j]).overlay = std::move(overlays[j]);
+    }
+}
 
-    auto top = 20;
-    auto ROW_HEIGHT = 30;
-    for (const auto &item: selection->getSlots()) {
-        // Display slots
-        for (const auto &slot: item.second) {
-            if (!(slot->getKind() & data->getSettings()->getFilter().getSlotKinds())) continue;
-
-            auto region = slot->region;
-            auto regionName = region->name();
-            auto regionNameStr = regionName.str();
-            auto startTime = slot->startTime.count();
-            auto endTime = slot->endTime.count();
-           
-
-            // Ensures slots starting before `begin` (like main) are considered to start at begin
-            auto effectiveStartTime = qMax(begin, startTime);
-            // Ensures slots ending after `end` (like main) are considered to end at end
-            auto effectiveEndTime = qMin(end, endTime);
-
-            auto slotBeginPos = (static_cast<qreal>(effectiveStartTime - begin) / static_cast<qreal>(runtime)) * width;
-            auto slotRuntime = static_cast<qreal>(effectiveEndTime - effectiveStartTime);
-            auto rectWidth = (slotRuntime / static_cast<qreal>(runtime)) * width;
-
-            QRectF rect(slotBeginPos, top, qMax(rectWidth, 5.0), ROW_HEIGHT);
-            auto rectItem = new SlotIndicator(rect, slot);
-            rectItem->setOnDoubleClick(onTimedElementDoubleClicked);
-            rectItem->setOnSelected(onTimedElementSelected);
-            rectItem->setToolTip(regionNameStr.c_str());
-
-            // Determine color based on name
-            rectItem->setBrush(slot->getColor());
-            rectItem->setZValue(slot->priority);
-            scene->addItem(rectItem);
-            
-            /*
-            QColor rectColor = slot->color;
-            
-            
-            
-            switch (slot->getKind()) {
-                case ::MPI:
-                    rectColor = colors::COLOR_SLOT_MPI;
-                    rectItem->setZValue(layers::Z_LAYER_SLOTS_MIN_PRIORITY + 2);
-                    break;
-                case ::OpenMP:
-                    rectColor = colors::COLOR_SLOT_OPEN_MP;
-                    rectItem->setZValue(layers::Z_LAYER_SLOTS_MIN_PRIORITY + 1);
-                    break;
-                case ::None:
-                case ::Plain:
-                default:
-                    rectColor = colors::COLOR_SLOT_PLAIN;
-                    rectItem->setZValue(layers::Z_LAYER_SLOTS_MIN_PRIORITY + 0);
-                    break;
+void TimelineView::renderSlots(QImage &image, const QRect &rect, const QRectF &area) const {
+    QPainter painter(&image);
+    painter.translate(-rect.topLeft());
+    painter.setClipRect(area);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(area, Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+    painter.setPen(QPen(Qt::black, 1));
+    auto firstRow = qMax(0, (rect.top() - layout::ROW_OFFSET) / layout::ROW_HEIGHT);
+    auto lastRow = qMin(static_cast<int>(rows.size()) - 1, (rect.bottom() - layout::ROW_OFFSET) / layout::ROW_HEIGHT);
+    if (rect.bottom() >= layout::ROW_OFFSET) {
+        for (auto rowIndex = firstRow; rowIndex <= lastRow; ++rowIndex) {
+            auto top = static_cast<qreal>(layout::ROW_OFFSET + rowIndex * layout::ROW_HEIGHT);
+            rasterizer.paintRow(painter, *rows[rowIndex].slots, top, layout::ROW_HEIGHT, area);
+            // Buckets are only read once the selection worker built them, see TraceDataProxy::getAggregatedSlots()
+            if (rows[rowIndex].node != SystemTree::NO_NODE && rows[rowIndex].slots != &emptySlots) {
+                paintMpiFraction(painter, rows[rowIndex].node, top, area);
             }
+        }
+    }
+}
+
+void TimelineView::renderOverlay(QImage &image, const QRect &rect) const {
+    image.fill(Qt::transparent);
 
-            rectItem->setBrush(rectColor);
-            scene->addItem(rectItem);
-            */          
+    QPainter painter(&image);
+    painter.translate(-rect.topLeft());
+    QRectF area(rect);
+
+    painter.setPen(QPen(Qt::black, 1));
+    painter.setBrush(Qt::NoBrush);
+    for (const auto &arrow: arrows) {
+        if (arrow.bounds.intersects(area)) {
+            painter.drawPolyline(arrow.polygon);
         }
+    }
 
-        top += ROW_HEIGHT;
+    painter.setPen(QPen(colors::COLOR_COLLECTIVE_COMMUNICATION, 2));
+    for (const auto &collective: collectives) {
+        if (collective.rect.adjusted(-1, -1, 1, 1).intersects(area)) {
+            painter.drawRect(collective.rect);
+        }
     }
+}
 
-    for (const auto &communication: selection->getCommunications()) {
-        const CommunicationEvent *startEvent = communication->getStartEvent();
-        auto startEventEnd = static_cast<qreal>(startEvent->getEndTime().count());
-        auto startEventStart = static_cast<qreal>(startEvent->getStartTime().count());
+void TimelineView::paintMpiFraction(QPainter &painter, std::size_t node, qreal top, const QRectF &area) const {
+    auto tree = data->getSystemTree();
+    const auto &treeNode = tree->nodes()[node];
+    auto capacity = static_cast<qreal>(tree->bucketWidth().count()) * static_cast<qreal>(qMax<std::size_t>(treeNode.ranks, 1));
+    auto bottom = top + layout::ROW_HEIGHT;
+
+    painter.save();
+    painter.setPen(Qt::NoPen);
+    auto color = colors::COLOR_SLOT_MPI;
+    color.setAlpha(160);
+    painter.setBrush(color);
+
+    auto from = rasterizer.toTime(area.left());
+    auto to = rasterizer.toTime(area.right() + 1);
+    tree->forEachBucket(node, from, to, [&](types::TraceTime start, types::TraceTime end, const SystemTree::Bucket &bucket) {
+        if (bucket.mpiTime <= 0) {
+            return;
+        }
+        auto fraction = qMin(static_cast<qreal>(bucket.mpiTime) / capacity, 1.0);
+        auto height = fraction * layout::ROW_HEIGHT / 2;
+        painter.drawRect(QRectF(QPointF(rasterizer.toX(start), bottom - height), QPointF(rasterizer.toX(end), bottom)));
+    });
+    painter.restore();
+}
 
+void TimelineView::paintEvent(QPaintEvent *event) {
+    QPainter painter(viewport());
+    auto offset = verticalScrollBar()->value();
+
+    auto dirty = event->rect().translated(0, offset);
+    auto firstStrip = qMax(0, dirty.top() / layout::STRIP_HEIGHT);
+    auto lastStrip = dirty.bottom() / layout::STRIP_HEIGHT;
+    renderStrips(firstStrip, lastStrip);
+    for (auto strip = firstStrip; strip <= lastStrip; ++strip) {
+        const auto &rendered = strips.at(strip);
+        painter.drawImage(QPoint(0, strip * layout::STRIP_HEIGHT - offset), rendered.slots);
+        painter.drawImage(QPoint(0, strip * layout::STRIP_HEIGHT - offset), rendered.overlay);
+    }
 
-        const CommunicationEvent *endEvent = communication->getEndEvent();
-        auto endEventEnd = static_cast<qreal>(startEvent->getEndTime().count());
-        auto endEventStart = static_cast<qreal>(startEvent->getStartTime().count());
+    if (!hovered.empty()) {
+        painter.translate(0, -offset);
+        painter.setPen(QPen(Qt::black, 2));
+        if (hovered.row) {
+            const auto &style = rasterizer.style(*hovered.row->slots, hovered.slot);
+            painter.setBrush(QColor::fromRgba(rasterizer.color(style.paletteIndex)));
+            painter.drawPolygon(hovered.outline);
+        } else {
+            painter.drawPolyline(hovered.outline);
+        }
+    }
 
+    // Drop strips that scrolled out of view once the cache grows too large
+    if (strips.size() > MAX_CACHED_STRIPS) {
+        auto visibleFirstStrip = offset / layout::STRIP_HEIGHT;
+        auto visibleLastStrip = (offset + viewport()->height()) / layout::STRIP_HEIGHT;
+        std::erase_if(strips, [&](const auto &entry) {
+            return entry.first < visibleFirstStrip || entry.first > visibleLastStrip;
+        });
+    }
+}
 
-        auto fromTime = startEventStart + (startEventEnd - startEventStart) / 2;
-        auto effectiveFromTime = qMax(beginR, fromTime) - beginR;
+void TimelineView::resizeEvent(QResizeEvent *event) {
+    QAbstractScrollArea::resizeEvent(event);
 
-        auto toTime = endEventStart + (endEventEnd - endEventStart) / 2;
-        auto effectiveToTime = qMin(endR, toTime) - beginR;
+    // The selection is summarized per device pixel of the widest view showing it
+    data->setResolution(this, qRound(static_cast<qreal>(viewport()->width()) * devicePixelRatioF()));
 
-        auto fromRank = startEvent->getLocation()->ref().get();
-        auto toRank = endEvent->getLocation()->ref().get();
+    // Strips only depend on the width, a change of the height only reveals more strips
+    if (static_cast<qreal>(viewport()->width()) != width) {
+        this->updateView();
+    } else {
+        this->updateScrollBars();
+    }
+    this->updateVisibleRows();
+}
+
+void TimelineView::scrollContentsBy(int, int) {
+    this->updateVisibleRows();
+    viewport()->update();
+}
+
+bool TimelineView::viewportEvent(QEvent *event) {
+    switch (event->type()) {
+        case QEvent::ToolTip: {
+            auto helpEvent = static_cast<QHelpEvent *>(event);
+            auto hit = elementAt(helpEvent->pos());
+            if (hit.row && hit.row->node != SystemTree::NO_NODE) {
+                QToolTip::showText(helpEvent->globalPos(), nodeToolTip(*hit.row, hit.slot), viewport());
+            } else if (hit.row) {
+                auto regionName = hit.row->slots->region(hit.slot)->name().str();
+                QToolTip::showText(helpEvent->globalPos(), QString::fromStdString(regionName), viewport());
+            } else {
+                QToolTip::hideText();
+                event->ignore();
+            }
+            return true;
+        }
+        case QEvent::Leave:
+            setHovered(Hit());
+            break;
+        default:
+            break;
+    }
+    return QAbstractScrollArea::viewportEvent(event);
+}
 
-        auto fromX = effectiveFromTime / runtimeR * width;
-        auto fromY = static_cast<qreal>(fromRank * ROW_HEIGHT) + .5 * ROW_HEIGHT + 20;
+void TimelineView::mousePressEvent(QMouseEvent *event) {
+    auto hit = event->button() == Qt::LeftButton ? elementAt(event->position().toPoint()) : Hit();
+    if (hit.empty()) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
 
-        auto toX = effectiveToTime / runtimeR * width;
-        auto toY = static_cast<qreal> (toRank * ROW_HEIGHT) + .5 * ROW_HEIGHT + 20;
+    if (hit.row && hit.row->node != SystemTree::NO_NODE) {
+        // Aggregated slots are no elements of the trace, they can only be zoomed into
+        event->accept();
+        return;
+    } else if (hit.row) {
+        // The proxy keeps its own copy of the slot
+        auto slot = hit.row->slots->slot(hit.slot, hit.row->locationGroup);
+        data->setTimeElementSelection(&slot);
+    } else {
+        data->setTimeElementSelection(hit.element);
+    }
+    event->accept();
+}
 
-        auto arrow = new CommunicationIndicator(communication, fromX, fromY, toX, toY);
-        arrow->setOnSelected(onTimedElementSelected);
-        arrow->setOnDoubleClick(onTimedElementDoubleClicked);
-        arrow->setPen(arrowPen);
-        arrow->setZValue(layers::Z_LAYER_P2P_COMMUNICATIONS);
-        scene->addItem(arrow);
+void TimelineView::mouseDoubleClickEvent(QMouseEvent *event) {
+    auto hit = event->button() == Qt::LeftButton ? elementAt(event->position().toPoint()) : Hit();
+    if (hit.row) {
+        data->setSelection(hit.row->slots->start(hit.slot), hit.row->slots->end(hit.slot));
+        event->accept();
+    } else if (dynamic_cast<Communication *>(hit.element)) {
+        data->setSelection(hit.element->getStartTime(), hit.element->getEndTime());
+        event->accept();
+    } else {
+        QAbstractScrollArea::mouseDoubleClickEvent(event);
     }
+}
 
-    for (const auto &communication: selection->getCollectiveCommunications()) {
-        auto fromTime = static_cast<qreal>(communication->getStartTime().count());
-        auto effectiveFromTime = qMax(beginR, fromTime) - beginR;
+void TimelineView::mouseMoveEvent(QMouseEvent *event) {
+    data->setZoomOrigin(event->position().x() / this->viewport()->width());
 
-        auto toTime = static_cast<qreal>(communication->getEndTime().count());
-        auto effectiveToTime = qMin(endR, toTime) - beginR;
+    auto hit = elementAt(event->position().toPoint());
+    // Collective communications span all rows and are not highlighted
+    if (dynamic_cast<CollectiveCommunicationEvent *>(hit.element)) {
+        hit = Hit();
+    }
+    setHovered(hit);
+    QAbstractScrollArea::mouseMoveEvent(event);
+}
 
-        auto fromX = (effectiveFromTime / runtimeR) * width;
-        auto fromY = 10;
+TimelineView::Hit TimelineView::elementAt(const QPoint &viewportPos) const {
+    Hit hit;
+    QPointF pos(viewportPos.x(), viewportPos.y() + verticalScrollBar()->value());
 
-        auto toX = (effectiveToTime / runtimeR) * width;
-        auto toY = top + 10;
+    // Communications are painted above slots, the last painted arrow is on top
+    for (auto it = arrows.rbegin(); it != arrows.rend(); ++it) {
+        if (it->bounds.contains(pos) && distanceToLine(QLineF(it->polygon[0], it->polygon[1]), pos) <= HIT_TOLERANCE) {
+            hit.element = it->communication;
+            hit.outline = it->polygon;
+            return hit;
+        }
+    }
 
-        auto rectItem = new CollectiveCommunicationIndicator(communication);
-        rectItem->setOnSelected(onTimedElementSelected);
-        rectItem->setRect(QRectF(QPointF(fromX, fromY), QPointF(toX, toY)));
-        rectItem->setPen(collectiveCommunicationPen);
-        rectItem->setZValue(layers::Z_LAYER_COLLECTIVE_COMMUNICATIONS);
-        scene->addItem(rectItem);
+    auto rowIndex = static_cast<int>(std::floor((pos.y() - layout::ROW_OFFSET) / layout::ROW_HEIGHT));
+    if (rowIndex >= 0 && rowIndex < static_cast<int>(rows.size())) {
+        const auto &row = rows[rowIndex];
+        auto top = static_cast<qreal>(layout::ROW_OFFSET + rowIndex * layout::ROW_HEIGHT);
+        if (auto slot = rasterizer.slotAt(*row.slots, pos, top, layout::ROW_HEIGHT)) {
+            hit.row = &row;
+            hit.slot = *slot;
+            hit.outline = QPolygonF(rasterizer.slotRect(*row.slots, *slot, top, layout::ROW_HEIGHT));
+            return hit;
+        }
     }
 
+    // Collective communications only respond if they do not cover anything else
+    for (auto it = collectives.rbegin(); it != collectives.rend(); ++it) {
+        if (it->rect.contains(pos)) {
+            hit.element = it->event;
+            hit.outline = QPolygonF(it->rect);
+            return hit;
+        }
+    }
+
+    return hit;
 }
 
+void TimelineView::setHovered(const Hit &hit) {
+    if (hit == hovered) {
+        return;
+    }
+    hovered = hit;
+    viewport()->update();
+}
 
-void TimelineView::resizeEvent(QResizeEvent *event) {
-    this->updateView();
-    QGraphicsView::resizeEvent(event);
+QString TimelineView::nodeToolTip(const Row &row, std::size_t slot) const {
+    auto tree = data->getSystemTree();
+    const auto &node = tree->nodes()[row.node];
+
+    // The MPI time is summed up over the buckets of the aggregated slot
+    double mpiTime = 0;
+    double capacity = 0;
+    tree->forEachBucket(row.node, row.slots->start(slot), row.slots->end(slot),
+                        [&](types::TraceTime, types::TraceTime, const SystemTree::Bucket &bucket) {
+                            mpiTime += bucket.mpiTime;
+                            capacity += static_cast<double>(tree->bucketWidth().count()) * static_cast<double>(node.ranks);
+                        });
+    auto mpiPercentage = capacity > 0 ? 100 * mpiTime / capacity : 0;
+
+    return tr("%1 %2 (%3 ranks)\nDominant region: %4\nMPI: %5%")
+        .arg(QString::fromStdString(node.className), QString::fromStdString(node.name))
+        .arg(node.ranks)
+        .arg(QString::fromStdString(row.slots->region(slot)->name().str()))
+        .arg(mpiPercentage, 0, 'f', 1);
 }
 
-void TimelineView::updateView() {
-    // TODO it might be more performant to keep track of items and add/remove new/leaving items and resizing them
-    this->scene()->clear();
+int TimelineView::contentHeight() const {
+    return layout::ROW_OFFSET * 2 + static_cast<int>(rows.size()) * layout::ROW_HEIGHT;
+}
+
+QPolygonF TimelineView::arrowPolygon(QPointF from, QPointF to, qreal headLength) {
+    QLineF line(to, from);
 
-    auto ROW_HEIGHT = 30;
-    auto sceneHeight = this->data->getSelection()->getSlots().size() * ROW_HEIGHT;
-    auto sceneRect = this->rect();
-    sceneRect.setHeight(sceneHeight);
+    QLineF headFirst = line.normalVector();
+    headFirst.setLength(headLength);
+    headFirst.setAngle(headFirst.angle() + 45 + 180);
 
-    this->scene()->setSceneRect(sceneRect);
-    this->populateScene(this->scene());
+    auto headSecond = QLineF(headFirst);
+    headSecond.setAngle(headSecond.angle() + 90);
+
+    QPolygonF arrow;
+    arrow << from << to << headFirst.p2() << to << headSecond.p2();
+    return arrow;
 }
 
 void TimelineView::wheelEvent(QWheelEvent *event) {
@@ -210,38 +551,22 @@ void TimelineView::wheelEvent(QWheelEvent *event) {
     if (!numDegrees.isNull() && QApplication::keyboardModifiers() & (Qt::CTRL | Qt::SHIFT)) {
         // See documentation and comment above
         QPoint numSteps = numDegrees / 15;
-        auto stepSize = data->getSelection()->getRuntime() / data->getSettings()->getZoomQuotient();
-        auto deltaDuration = stepSize * numSteps.y();
-        auto delta = static_cast<double>(deltaDuration.count());
 
-        types::TraceTime newBegin;
-        types::TraceTime newEnd;
+        // The windows are computed by the proxy, which prefetches the selections of single steps
+        std::pair<types::TraceTime, types::TraceTime> window;
         if (QApplication::keyboardModifiers() == Qt::CTRL) {
-            // Calculate the position of the mouse relative to the scene to zoom to where the mouse is pointed
-            auto originFactor = event->scenePosition().x() / this->scene()->width();
-
-            auto leftDelta = types::TraceTime(static_cast<long>(originFactor * 2 * delta));
-            auto rightDelta = types::TraceTime(static_cast<long>((1 - originFactor) * 2 * delta));
-
-            newBegin = data->getSelection()->getStartTime() + leftDelta;
-            newEnd = data->getSelection()->getStartTime() + data->getSelection()->getRuntime() - rightDelta;
+            // Zoom to where the mouse is pointed
+            auto originFactor = event->position().x() / this->viewport()->width();
+            window = data->zoomedWindow(numSteps.y(), originFactor);
         } else {
-            // Calculate new absolute times (might be negative or to large)
-            auto newBeginAbs = data->getSelection()->getStartTime() - deltaDuration;
-            auto newEndAbs = data->getSelection()->getStartTime() + data->getSelection()->getRuntime() - deltaDuration;
-
-            // Limit the times to their boundaries (0 for start and end of entire trace for end)
-            auto newBeginBounded = qMax(newBeginAbs, types::TraceTime(0));
-            auto newEndBounded = qMin(newEndAbs, data->getTotalRuntime());
-
-            // If one time exceeds the bounds reject the changes
-            newBegin = qMin(newBeginBounded, newEndBounded - data->getSelection()->getRuntime());
-            newEnd = qMax(newEndBounded, newBeginBounded + data->getSelection()->getRuntime());
+            window = data->pannedWindow(numSteps.y());
         }
+        auto [newBegin, newEnd] = window;
 
         data->setSelection(newBegin, newEnd);
         event->accept();
+        return;
     }
 
-    QGraphicsView::wheelEvent(event);
+    QAbstractScrollArea::wheelEvent(event);
 }
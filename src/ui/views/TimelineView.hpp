@@ -19,18 +19,39 @@
 #define MOTIV_TIMELINEVIEW_HPP
 
 
-#include <QGraphicsView>
+#include <unordered_map>
+#include <vector>
+
+#include <QAbstractScrollArea>
+#include <QImage>
+#include <QPolygonF>
 
 #include "src/ui/TraceDataProxy.hpp"
-//#include "src/ui/views/ColorGenerator.hpp"
+#include "src/ui/views/RowRasterizer.hpp"
 
 /**
  * @brief The main view component rendering the trace
  *
  * This class is the main component responsible for rendering all slots, communications and collective communications.
- * The scene is rerendered whenever the selected time window of the trace changes or the window is resized.
+ * Instead of creating a graphics item per element, the view paints the selection directly into image strips spanning
+ * the width of the view and layout::STRIP_HEIGHT pixels. Missing strips are rasterized in parallel on the global thread
+ * pool, the GUI thread only composites them. Strips are cached until the selection, the filter, the colors or the
+ * width of the view change, so vertical scrolling only blits already rendered strips.
+ *
+ * Slots are rendered into one image of a strip, communications into another one on top. If the selection only moved
+ * its window by whole pixels, see TraceDataProxy::getPannedFrom(), the slot images are moved and only the exposed
+ * columns are rendered, while communications are rendered again.
+ *
+ * Clicks, hovering and tooltips are resolved against the slot index of the selection instead of scene items.
+ *
+ * The view reports the rows scrolled into view and its width in device pixels to the TraceDataProxy, which only computes
+ * slots for these rows at this resolution. Windows that are slow to compute arrive coarse first and refined later, the
+ * strips are rendered again for each of them.
+ *
+ * Rows follow TraceDataProxy::getRows(). A collapsed system tree node is drawn from its cached aggregate: the dominant
+ * region over time and, at the bottom of the row, the fraction of its ranks spending their time in MPI.
  */
-class TimelineView : public QGraphicsView {
+class TimelineView : public QAbstractScrollArea {
 Q_OBJECT
 
 public:
@@ -58,24 +79,151 @@ public Q_SLOTS:
      */
     void updateView();
 
+    /**
+     * @brief Repaints the view after the colors of regions have changed.
+     */
+    void updateColors();
+
 protected:
     /**
-     * @copydoc QGraphicsView::resizeEvent(QResizeEvent*)
+     * @copydoc QAbstractScrollArea::paintEvent(QPaintEvent*)
+     */
+    void paintEvent(QPaintEvent *event) override;
+
+    /**
+     * @copydoc QAbstractScrollArea::resizeEvent(QResizeEvent*)
      */
     void resizeEvent(QResizeEvent *event) override;
 
     /**
-     * @copydoc QGraphicsView::wheelEvent(QWheelEvent*)
+     * @copydoc QAbstractScrollArea::scrollContentsBy(int, int)
+     */
+    void scrollContentsBy(int dx, int dy) override;
+
+    /**
+     * @copydoc QAbstractScrollArea::viewportEvent(QEvent*)
+     */
+    bool viewportEvent(QEvent *event) override;
+
+    /**
+     * @copydoc QAbstractScrollArea::wheelEvent(QWheelEvent*)
      */
     void wheelEvent(QWheelEvent *event) override;
 
+    /**
+     * @copydoc QAbstractScrollArea::mousePressEvent(QMouseEvent*)
+     */
+    void mousePressEvent(QMouseEvent *event) override;
+
+    /**
+     * @copydoc QAbstractScrollArea::mouseDoubleClickEvent(QMouseEvent*)
+     */
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+    /**
+     * @copydoc QAbstractScrollArea::mouseMoveEvent(QMouseEvent*)
+     */
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    /**
+     * @brief A row of the timeline showing the slots of one location group or the aggregate of a system tree node
+     */
+    struct Row {
+        otf2::definition::location_group *locationGroup;
+        std::size_t node;
+        const SlotStore *slots;
+    };
+
+    /**
+     * @brief A communication arrow in content coordinates
+     */
+    struct Arrow {
+        Communication *communication;
+        QPolygonF polygon;
+        QRectF bounds;
+    };
+
+    /**
+     * @brief A collective communication in content coordinates
+     */
+    struct Collective {
+        CollectiveCommunicationEvent *event;
+        QRectF rect;
+    };
+
+    /**
+     * @brief A strip of the content, slots and communications are rendered separately
+     */
+    struct Strip {
+        QImage slots;
+        QImage overlay; /**< Communications painted on top of the slots, null if not yet rendered */
+    };
+
+    /**
+     * @brief An element found at a position of the view
+     *
+     * Slots are identified by their row and index in the slot store, communications by their element.
+     */
+    struct Hit {
+        TimedElement *element = nullptr;
+        const Row *row = nullptr;
+        std::size_t slot = 0;
+        QPolygonF outline;
+
+        [[nodiscard]] bool empty() const { return element == nullptr && row == nullptr; }
+
+        bool operator==(const Hit &rhs) const {
+            return element == rhs.element && row == rhs.row && (row == nullptr || slot == rhs.slot);
+        }
+    };
+
 private:
-    void populateScene(QGraphicsScene *element);
+    void updateGeometry();
+    void updateScrollBars();
+    void updateVisibleRows();
+    void invalidateStrips();
+    bool shiftStrips(types::TraceTime previousBegin);
+
+    void renderStrips(int first, int last);
+    void renderSlots(QImage &image, const QRect &rect, const QRectF &area) const;
+    void renderOverlay(QImage &image, const QRect &rect) const;
+    void paintMpiFraction(QPainter &painter, std::size_t node, qreal top, const QRectF &area) const;
+
+    [[nodiscard]] Hit elementAt(const QPoint &viewportPos) const;
+    void setHovered(const Hit &hit);
+
+    [[nodiscard]] QString nodeToolTip(const Row &row, std::size_t slot) const;
+    [[nodiscard]] int contentHeight() const;
+
+    static QPolygonF arrowPolygon(QPointF from, QPointF to, qreal headLength = 10);
 
 private:
     TraceDataProxy *data = nullptr;
-  //  ColorGenerator colorgenerator;
-    
+
+    /**
+     * Trace the geometry below was built from, the cached tiles are only valid for this trace
+     */
+    Trace *selection = nullptr;
+
+    /**
+     * Start of the window of selection, the selection itself may be deleted before the view is updated
+     */
+    types::TraceTime selectionBegin{0};
+    RowRasterizer rasterizer;
+    qreal width = 0;
+
+    std::vector<Row> rows;
+    SlotStore emptySlots;
+    std::vector<Arrow> arrows;
+    std::vector<Collective> collectives;
+
+    /**
+     * Rendered strips by their index from the top of the content
+     */
+    std::unordered_map<int, Strip> strips;
+
+    Hit hovered;
 };
 
 
@@ -16,12 +16,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TraceOverviewTimelineView.hpp"
-#include "src/ui/views/CommunicationIndicator.hpp"
 #include "src/ui/ColorGenerator.hpp"
 #include "src/ui/Constants.hpp"
 #include "src/models/UITrace.hpp"
+#include "src/ui/views/RowRasterizer.hpp"
 
 
+#include <cmath>
+
+#include <QGraphicsPixmapItem>
 #include <QGraphicsRectItem>
 #include <QApplication>
 #include <QWheelEvent>
@@ -41,62 +44,46 @@ TraceOverviewTimelineView::TraceOverviewTimelineView(Trace *fullTrace, QWidget *
 
 void TraceOverviewTimelineView::populateScene(QGraphicsScene *scene) {
     auto width = scene->width();
-    auto runtime = uiTrace->getRuntime().count();
-    auto begin = 0;
-    auto end = begin + runtime;
+    auto height = scene->height();
 
-    qreal top = 0;
-    auto ROW_HEIGHT = scene->height() / static_cast<qreal>(uiTrace->getSlots().size());
+    std::vector<const SlotStore *> rows;
     for (const auto &item: uiTrace->getSlots()) {
-        // Display slots
-        for (const auto &slot: item.second) {
-            auto startTime = slot->startTime.count();
-            auto endTime = slot->endTime.count();
-
-
-            // Ensures slots starting before `begin` (like main) are considered to start at begin
-            auto effectiveStartTime = qMax(begin, startTime);
-            // Ensures slots ending after `end` (like main) are considered to end at end
-            auto effectiveEndTime = qMin(end, endTime);
-
-            auto slotBeginPos = qMax(0.0,
-                                     (static_cast<qreal>(effectiveStartTime - begin) / static_cast<qreal>(runtime)) *
-                                     width);
-            auto slotRuntime = static_cast<qreal>(effectiveEndTime - effectiveStartTime);
-            auto rectWidth = (slotRuntime / static_cast<qreal>(runtime)) * width;
-
-            QRectF rect(slotBeginPos, top, qMax(rectWidth, 5.0), ROW_HEIGHT);
-            auto rectItem = scene->addRect(rect);
-
-            // Determine color based on name
-            QColor rectColor = slot->getColor();
-            rectItem->setZValue(slot->priority);
-            
-            /*
-            switch (slot->getKind()) {
-                case ::MPI:
-                    rectColor = colors::COLOR_SLOT_MPI;
-                    rectItem->setZValue(layers::Z_LAYER_SLOTS_MIN_PRIORITY + 2);
-                    break;
-                case ::OpenMP:
-                    rectColor = colors::COLOR_SLOT_OPEN_MP;
-                    rectItem->setZValue(layers::Z_LAYER_SLOTS_MIN_PRIORITY + 1);
-                    break;
-                case ::None:
-                case ::Plain:
-                default:
-                    rectColor = colors::COLOR_SLOT_PLAIN;
-                    rectItem->setZValue(layers::Z_LAYER_SLOTS_MIN_PRIORITY + 0);
-                    break;
-            }
-            */
-
-            rectItem->setBrush(rectColor);
+        rows.push_back(&item.second);
+    }
+    auto ROW_HEIGHT = rows.empty() ? height : height / static_cast<qreal>(rows.size());
+
+    // Every worker rasterizes the rows of one horizontal band into its own image
+    auto allKinds = static_cast<SlotKind>(MPI | OpenMP | Plain);
+    RowRasterizer rasterizer(uiTrace, types::TraceTime(0), uiTrace->getRuntime(), width, allKinds);
+    auto bandCount = qMax<std::size_t>(1, qMin<std::size_t>(rows.size(), QThreadPool::globalInstance()->maxThreadCount()));
+    auto bandHeight = static_cast<int>(std::ceil(height / static_cast<qreal>(bandCount)));
+    auto bandWidth = static_cast<int>(std::ceil(width));
+    auto pixelRatio = devicePixelRatioF();
+    std::vector<QImage> bands(bandCount);
+    RowRasterizer::forEachParallel(bandCount, [&](std::size_t band) {
+        QRect rect(0, static_cast<int>(band) * bandHeight, bandWidth, bandHeight);
+        auto &image = bands[band];
+        image = QImage(rect.size() * pixelRatio, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(pixelRatio);
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        painter.translate(-rect.topLeft());
+        painter.setPen(QPen(Qt::black, 1));
+        auto firstRow = static_cast<std::size_t>(qMax(0.0, std::floor(rect.top() / ROW_HEIGHT)));
+        auto lastRow = qMin(rows.size(), static_cast<std::size_t>(std::floor(rect.bottom() / ROW_HEIGHT)) + 1);
+        for (auto row = firstRow; row < lastRow; ++row) {
+            rasterizer.paintRow(painter, *rows[row], static_cast<qreal>(row) * ROW_HEIGHT, ROW_HEIGHT, QRectF(rect));
         }
+    });
 
-        top += ROW_HEIGHT;
+    for (std::size_t band = 0; band < bandCount; ++band) {
+        auto item = scene->addPixmap(QPixmap::fromImage(bands[band]));
+        item->setPos(0, static_cast<qreal>(band) * bandHeight);
     }
 
+    auto top = static_cast<qreal>(rows.size()) * ROW_HEIGHT;
+
     QPen selectionPen(Qt::black);
     QBrush selectionBrush(QColor(0xFF, 0xFF, 0xFF, 0x7F));
     selectionRectRight = scene->addRect(width - 1,0, 0, top, selectionPen, selectionBrush);
@@ -109,6 +96,7 @@ void TraceOverviewTimelineView::populateScene(QGraphicsScene *scene) {
 
 
 void TraceOverviewTimelineView::resizeEvent(QResizeEvent *event) {
+    delete uiTrace;
     uiTrace = UITrace::forResolution(fullTrace, event->size().width());
 
     this->updateView();
@@ -116,10 +104,18 @@ void TraceOverviewTimelineView::resizeEvent(QResizeEvent *event) {
 }
 
 void TraceOverviewTimelineView::updateUITrace(){    
+    delete uiTrace;
     uiTrace = UITrace::forResolution(fullTrace, window()->size().width());
      this->updateView();
 }
 
+void TraceOverviewTimelineView::setFullTrace(Trace *newTrace) {
+    fullTrace = newTrace;
+    delete uiTrace;
+    uiTrace = UITrace::forResolution(fullTrace, qMax(1, this->width()));
+    this->updateView();
+}
+
 void TraceOverviewTimelineView::updateView() {
     this->scene()->clear();
 
@@ -71,6 +71,12 @@ public Q_SLOTS:
      */
     void updateUITrace();
 
+    /**
+     * @brief Replaces the displayed trace
+     * @param newTrace Pointer to the new entire trace
+     */
+    void setFullTrace(Trace *newTrace);
+
 protected:
     /**
      * @copydoc QGraphicsView::mousePressEvent(QMouseEvent*)
@@ -16,29 +16,76 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TimelineLabelList.hpp"
+#include "src/ui/Constants.hpp"
 
-#include <QLabel>
-#include <QSizePolicy>
-#include <QVBoxLayout>
+TimelineLabelModel::TimelineLabelModel(TraceDataProxy *data, QObject *parent) : QAbstractListModel(parent), data(data) {}
 
-TimelineLabelList::TimelineLabelList(TraceDataProxy *data, QWidget *parent) : QListWidget(parent), data(data) {
+void TimelineLabelModel::updateRows() {
+    beginResetModel();
+    endResetModel();
+}
+
+int TimelineLabelModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(data->getRows().size());
+}
+
+QVariant TimelineLabelModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount(QModelIndex())) {
+        return {};
+    }
+
+    const auto &row = data->getRows()[index.row()];
+    switch (role) {
+        case Qt::DisplayRole: {
+            auto indentation = QString(static_cast<qsizetype>(2 * row.depth), ' ');
+            if (row.node == SystemTree::NO_NODE) {
+                return indentation + QString::fromStdString(row.locationGroup->name().str());
+            }
+
+            const auto &node = data->getSystemTree()->nodes()[row.node];
+            return indentation + (data->isExpanded(row.node) ? "▾ " : "▸ ") + QString("%1 %2 (%3)")
+                .arg(QString::fromStdString(node.className), QString::fromStdString(node.name))
+                .arg(node.ranks);
+        }
+        case Qt::SizeHintRole:
+            return QSize(0, layout::ROW_HEIGHT);
+        case Qt::TextAlignmentRole:
+            // Hierarchical rows start with a system tree node, flat rows have nothing to indent
+            if (data->getRows().front().node != SystemTree::NO_NODE) {
+                return static_cast<int>(Qt::AlignLeft | Qt::AlignVCenter);
+            }
+            return static_cast<int>(Qt::AlignCenter);
+        default:
+            return {};
+    }
+}
+
+TimelineLabelList::TimelineLabelList(TraceDataProxy *data, QWidget *parent)
+    : QListView(parent), data(data), model(new TimelineLabelModel(data, this)) {
     this->setFrameShape(QFrame::NoFrame);
     this->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     this->setStyleSheet("background: transparent");
-    setViewportMargins(0, 20, 0, 0);
-
-    for (const auto &ranks: this->data->getSelection()->getSlots()) {
-        const auto &rankName = ranks.first->name().str();
-        auto item = new QListWidgetItem(this);
-        item->setText(QString::fromStdString(rankName));
-        item->setSizeHint(QSize(0, 30 /* TODO ROW_HEIGHT */));
-        item->setTextAlignment(Qt::AlignCenter);
-        this->addItem(item);
-    }
+    this->setUniformItemSizes(true);
+    // Scroll by pixels like the TimelineView the list is synchronized with
+    this->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    this->setSelectionMode(QAbstractItemView::NoSelection);
+    setViewportMargins(0, layout::ROW_OFFSET, 0, 0);
+    this->setModel(model);
+
+    this->updateLabels();
+    connect(this->data, &TraceDataProxy::traceChanged, this, &TimelineLabelList::updateLabels);
+    connect(this->data, &TraceDataProxy::rowsChanged, this, &TimelineLabelList::updateLabels);
 }
 
-void TimelineLabelList::mousePressEvent(QMouseEvent *) {
-    return;
+void TimelineLabelList::updateLabels() {
+    model->updateRows();
+}
+
+void TimelineLabelList::mousePressEvent(QMouseEvent *event) {
+    auto index = indexAt(event->position().toPoint());
+    if (event->button() == Qt::LeftButton && index.isValid()) {
+        data->toggleRow(static_cast<std::size_t>(index.row()));
+    }
 }
 
 void TimelineLabelList::mouseReleaseEvent(QMouseEvent *) {
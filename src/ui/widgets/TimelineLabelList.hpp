@@ -19,16 +19,57 @@
 #define MOTIV_TIMELINELABELLIST_HPP
 
 
-#include <QListWidget>
+#include <QAbstractListModel>
+#include <QListView>
 
 #include "src/ui/TraceDataProxy.hpp"
 
+/**
+ * @brief List model of the labels of the rows of the timeline
+ *
+ * The model follows TraceDataProxy::getRows(). Location groups are labeled with their name, system tree nodes with their
+ * class, name and number of ranks, indented by their depth. Names are only looked up for the rows the view asks for.
+ */
+class TimelineLabelModel : public QAbstractListModel {
+public:
+    /**
+     * @brief Creates a new instance of the TimelineLabelModel class
+     *
+     * @param data The data proxy providing the rows
+     * @param parent The parent QObject
+     */
+    explicit TimelineLabelModel(TraceDataProxy *data, QObject *parent = nullptr);
+
+    /**
+     * @brief Notifies views that the rows of the data proxy changed
+     */
+    void updateRows();
+
+    /**
+     * @copydoc QAbstractListModel::rowCount(const QModelIndex&)
+     */
+    [[nodiscard]] int rowCount(const QModelIndex &parent) const override;
+
+    /**
+     * @copydoc QAbstractListModel::data(const QModelIndex&, int)
+     */
+    [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override;
+
+private:
+    TraceDataProxy *data = nullptr;
+};
+
 /**
  * @brief The TimelineLabelList displays a vertical bar with a list of rank names.
  *
+ * Clicking the label of a system tree node expands or collapses the node.
+ *
+ * The list is backed by a TimelineLabelModel with uniform item sizes, so only the labels of visible rows are laid out
+ * and painted.
+ *
  * TODO: for configurable region heights, the height of the labels should be adjusted here too
  */
-class TimelineLabelList : public QListWidget {
+class TimelineLabelList : public QListView {
     Q_OBJECT
 
 public:
@@ -40,9 +81,15 @@ public:
      */
     TimelineLabelList(TraceDataProxy *data, QWidget *parent = nullptr);
 
+public Q_SLOTS:
+    /**
+     * @brief Recreates the labels from the rows of the data proxy
+     */
+    void updateLabels();
+
 protected:
     /*
-     * NOTE: we override this function to prevent the items from being clicked/activated.
+     * NOTE: we override these functions to prevent the items from being clicked/activated.
      * this is quite hacky and there might be a better solution.
      */
 
@@ -61,6 +108,7 @@ protected:
 
 private:
     TraceDataProxy *data = nullptr;
+    TimelineLabelModel *model = nullptr;
 };
 
 
@@ -20,7 +20,7 @@
 
 void InformationDockSlotStrategy::updateView(QFormLayout *layout, Slot *element) {
     auto name = QString::fromStdString(element->region->name().str());
-    auto rank = QString::fromStdString(element->location->location_group().name().str());
+    auto rank = QString::fromStdString(element->locationGroup->name().str());
 
     nameField->setText(name);
     rankField->setText(rank);
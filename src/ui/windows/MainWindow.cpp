@@ -25,7 +25,9 @@
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QProcess>
+#include <QStatusBar>
 #include <QToolBar>
+#include <algorithm>
 #include <utility>
 
 #include "src/models/AppSettings.hpp"
@@ -51,29 +53,38 @@ extern bool testRun;
 
 ColorSynchronizer* colorsynchronizer = ColorSynchronizer::getInstance();
 
+/**
+ * Default colors of the slot kinds, shown until the colors of the regions of a trace are resolved
+ */
+static const DefinitionRegistry::KindColors KIND_COLORS{colors::COLOR_SLOT_MPI.rgba(), colors::COLOR_SLOT_OPEN_MP.rgba(),
+                                                        colors::COLOR_SLOT_PLAIN.rgba()};
 
-MainWindow::MainWindow(QString filepath) : QMainWindow(nullptr), filepath(std::move(filepath)) {
+MainWindow::MainWindow(QString filepath, std::size_t loadJobs) : QMainWindow(nullptr), filepath(std::move(filepath)),
+                                                                loadJobs(loadJobs) {
     if (this->filepath.isEmpty()) {
         this->promptFile();
     }
     this->loadSettings();   
     AppSettings::getInstance().setColorConfigName(this->filepath);
     AppSettings::getInstance().loadColorConfigs();
- 
-    this->loadTrace();
 
-    this->createToolBars();
-    this->createDockWidgets();
-    this->createCentralWidget();
-    this->createMenus();
-
-    colorsynchronizer->setData(this->data);
+    // Test runs measure loading, so the trace is loaded synchronously
+    if (testRun) {
+        this->loadTrace();
+    } else {
+        this->startLoading();
+    }
 }
 
 MainWindow::~MainWindow() {
+    if (this->loaderThread) {
+        this->loader->progress().cancel();
+        this->loaderThread->wait();
+    }
+    this->previewPool.waitForDone();
+
     delete this->data;
-    delete this->callbacks;
-    delete this->reader;
+    delete this->loadedTrace;
     delete this->settings;
 
     delete this->traceOverview;
@@ -146,6 +157,21 @@ void MainWindow::createMenus() {
     connect(resetZoomAction, SIGNAL(triggered()), this, SLOT(resetZoom()));
     resetZoomAction->setShortcut(tr("Ctrl+R"));
 
+    auto zoomBackAction = new QAction(tr("Zoom &back"));
+    zoomBackAction->setShortcut(QKeySequence::Back);
+    zoomBackAction->setEnabled(data->canZoomBack());
+    connect(zoomBackAction, &QAction::triggered, data, &TraceDataProxy::zoomBack);
+
+    auto zoomForwardAction = new QAction(tr("Zoom f&orward"));
+    zoomForwardAction->setShortcut(QKeySequence::Forward);
+    zoomForwardAction->setEnabled(data->canZoomForward());
+    connect(zoomForwardAction, &QAction::triggered, data, &TraceDataProxy::zoomForward);
+
+    connect(data, &TraceDataProxy::historyChanged, this, [zoomBackAction, zoomForwardAction](bool back, bool forward) {
+        zoomBackAction->setEnabled(back);
+        zoomForwardAction->setEnabled(forward);
+    });
+
     auto widgetMenuCustomColors = new QMenu(tr("Custom Colors"));
 
     auto loadGlobalColorsAction = new QAction(tr("&Load gobal colors"));
@@ -184,6 +210,8 @@ void MainWindow::createMenus() {
     viewMenu->addAction(filterAction);
     viewMenu->addAction(searchAction);
     viewMenu->addAction(resetZoomAction);   
+    viewMenu->addAction(zoomBackAction);
+    viewMenu->addAction(zoomForwardAction);
     viewMenu->addMenu(widgetMenuCustomColors);
     viewMenu->addMenu(widgetMenuToolWindows);
 
@@ -301,25 +329,182 @@ void MainWindow::loadTrace() {
         loadTraceTimer.start();
     }
 
-    this->reader = new otf2::reader::reader(this->filepath.toStdString());
-    this->callbacks = new ReaderCallbacks(*reader);
+    TraceLoader loader(this->filepath.toStdString(), KIND_COLORS, this->loadJobs);
+    auto trace = loader.load();
 
-    this->reader->set_callback(*callbacks);
-    this->reader->read_definitions();
-    this->reader->read_events();
-
-    auto slots = this->callbacks->getSlots();
-    auto communications = this->callbacks->getCommunications();
-    auto collectives = this->callbacks->getCollectiveCommunications();
-    auto trace = new FileTrace(slots, communications, collectives, this->callbacks->duration());
-
-    this->data = new TraceDataProxy(trace, this->settings, this);
+    this->showTrace(trace);
 
     if(testRun==true){
         std::cout << "%MainWindow::loadTrace()%" << loadTraceTimer.elapsed() << "%ms%";
     }
 }
 
+void MainWindow::startLoading() {
+    this->loader = std::make_shared<TraceLoader>(this->filepath.toStdString(), KIND_COLORS, this->loadJobs);
+
+    this->loadingProgressBar = new QProgressBar(this);
+    this->loadingProgressBar->setRange(0, 1000);
+    this->loadingProgressBar->setFormat(tr("Reading definitions..."));
+    this->statusBar()->addPermanentWidget(this->loadingProgressBar, 1);
+
+    this->cancelLoadingButton = new QPushButton(tr("Cancel"), this);
+    connect(this->cancelLoadingButton, &QPushButton::clicked, this, &MainWindow::cancelLoading);
+    this->statusBar()->addPermanentWidget(this->cancelLoadingButton);
+
+    this->loaderThread = QThread::create([this] {
+        try {
+            this->loadedTrace = this->loader->load();
+        } catch (const std::exception &e) {
+            this->loadingError = QString::fromStdString(e.what());
+        }
+    });
+    connect(this->loaderThread, &QThread::finished, this, &MainWindow::loadingFinished);
+
+    this->loadingTimer = new QTimer(this);
+    this->loadingTimer->setInterval(100);
+    connect(this->loadingTimer, &QTimer::timeout, this, &MainWindow::updateLoadingProgress);
+
+    this->previewTimer.start();
+    this->loadingTimer->start();
+    this->loaderThread->start();
+}
+
+void MainWindow::updateLoadingProgress() {
+    if (!this->loader) {
+        return;
+    }
+    auto &progress = this->loader->progress();
+    if (progress.cancelled()) {
+        return;
+    }
+
+    switch (progress.stage()) {
+        case LoadProgress::ReadingDefinitions:
+            return;
+        case LoadProgress::ReadingEvents:
+            break;
+        case LoadProgress::Linking:
+        case LoadProgress::Done:
+            this->loadingProgressBar->setValue(1000);
+            this->loadingProgressBar->setFormat(tr("Linking communications..."));
+            return;
+    }
+
+    auto locations = progress.locations();
+    std::uint64_t events = 0, totalEvents = 0, bytes = 0, totalBytes = 0;
+    for (const auto &location: locations) {
+        events += location.events;
+        totalEvents += location.totalEvents;
+        bytes += location.bytes;
+        totalBytes += location.totalBytes;
+    }
+
+    auto mib = [](std::uint64_t bytes) { return QString::number(static_cast<double>(bytes) / (1 << 20), 'f', 1); };
+    this->loadingProgressBar->setValue(totalEvents ? static_cast<int>(events * 1000 / totalEvents) : 0);
+    this->loadingProgressBar->setFormat(tr("%1 of %2 events, %3 of %4 MiB read")
+                                            .arg(events).arg(totalEvents).arg(mib(bytes)).arg(mib(totalBytes)));
+
+    // Locations furthest behind are the ones holding up loading
+    std::sort(locations.begin(), locations.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.events * std::max<std::uint64_t>(rhs.totalEvents, 1) <
+               rhs.events * std::max<std::uint64_t>(lhs.totalEvents, 1);
+    });
+    QStringList lines;
+    for (std::size_t i = 0; i < std::min<std::size_t>(locations.size(), 16); ++i) {
+        const auto &location = locations[i];
+        lines << tr("%1 (%2): %3 of %4 events, %5 of %6 MiB")
+            .arg(QString::fromStdString(location.location->location_group().name().str()))
+            .arg(QString::fromStdString(location.location->name().str()))
+            .arg(location.events).arg(location.totalEvents)
+            .arg(mib(location.bytes)).arg(mib(location.totalBytes));
+    }
+    this->loadingProgressBar->setToolTip(lines.join('\n'));
+
+    // The first preview shows the ranks as soon as the definitions are read, later ones are throttled as building
+    // them copies all slots read so far
+    auto generation = progress.generation();
+    if (this->buildingPreview ||
+        (this->data && (generation == this->previewGeneration || this->previewTimer.elapsed() < 1000))) {
+        return;
+    }
+
+    // Building a preview takes time proportional to the slots read so far, only the finished trace is handed over
+    this->buildingPreview = true;
+    this->previewGeneration = generation;
+    this->previewTimer.restart();
+    this->previewPool.start([this, loader = this->loader] {
+        auto preview = loader->preview();
+        QMetaObject::invokeMethod(this, [this, preview] { this->previewBuilt(preview); }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::previewBuilt(FileTrace *preview) {
+    this->buildingPreview = false;
+
+    // The definitions may not have been read yet, or loading finished or was cancelled in the meantime
+    if (!preview || !this->loaderThread || this->loader->progress().cancelled()) {
+        delete preview;
+        return;
+    }
+    this->showTrace(preview);
+}
+
+void MainWindow::loadingFinished() {
+    this->loadingTimer->stop();
+    this->loaderThread->wait();
+    this->loaderThread->deleteLater();
+    this->loaderThread = nullptr;
+    this->loader.reset();
+
+    this->statusBar()->removeWidget(this->loadingProgressBar);
+    this->statusBar()->removeWidget(this->cancelLoadingButton);
+    this->loadingProgressBar->deleteLater();
+    this->cancelLoadingButton->deleteLater();
+    this->loadingProgressBar = nullptr;
+    this->cancelLoadingButton = nullptr;
+
+    if (!this->loadedTrace) {
+        if (!this->loadingError.isEmpty()) {
+            QMessageBox::critical(this, tr("Loading failed"), tr("The trace could not be loaded: %1").arg(this->loadingError));
+        }
+        this->close();
+        return;
+    }
+
+    auto trace = this->loadedTrace;
+    this->loadedTrace = nullptr;
+    this->showTrace(trace);
+}
+
+void MainWindow::cancelLoading() {
+    this->loader->progress().cancel();
+    this->cancelLoadingButton->setEnabled(false);
+    this->loadingProgressBar->setFormat(tr("Cancelling..."));
+}
+
+void MainWindow::showTrace(FileTrace *trace) {
+    // The palette is only changed on the GUI thread, see DefinitionRegistry
+    if (auto definitions = trace->getDefinitions()) {
+        for (auto region: trace->getRegions()) {
+            definitions->resolveColor(region);
+        }
+    }
+
+    if (this->data) {
+        this->data->setFullTrace(trace);
+        return;
+    }
+
+    this->data = new TraceDataProxy(trace, this->settings, this);
+
+    this->createToolBars();
+    this->createDockWidgets();
+    this->createCentralWidget();
+    this->createMenus();
+
+    colorsynchronizer->setData(this->data);
+}
+
 void MainWindow::loadSettings() {
     this->settings = new ViewSettings();
 }
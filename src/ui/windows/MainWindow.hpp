@@ -21,13 +21,19 @@
 
 #include <QMainWindow>
 #include <QElapsedTimer>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
 #include <iostream>
+#include <memory>
 
 #include<QDebug>
 
 #include "src/ui/widgets/TimeInputField.hpp"
 #include "src/ui/TraceDataProxy.hpp"
-#include "src/ReaderCallbacks.hpp"
+#include "src/TraceLoader.hpp"
 #include "src/ui/widgets/TraceOverviewDock.hpp"
 #include "src/ui/widgets/InformationDock.hpp"
 #include "src/ui/widgets/License.hpp"
@@ -47,8 +53,9 @@ public: // constructors
      * @brief Creates a new instance of the MainWindow class.
      *
      * @param filepath Path to trace file. If omitted the user is promted for it.
+     * @param loadJobs Number of threads used to load the trace. If 0, the number of hardware threads is used.
      */
-    explicit MainWindow(QString filepath = QString());
+    explicit MainWindow(QString filepath = QString(), std::size_t loadJobs = 0);
     ~MainWindow() override;
 
 public: Q_SIGNALS:
@@ -92,6 +99,13 @@ public Q_SLOTS:
      */
     void openNewTrace();
 
+    /**
+     * @brief Cancels loading the trace
+     *
+     * The window is closed once the loader has stopped.
+     */
+    void cancelLoading();
+
 private: // methods
     void createMenus();
     void createToolBars();
@@ -100,6 +114,11 @@ private: // methods
 
     QString promptFile();
     void loadTrace();
+    void startLoading();
+    void updateLoadingProgress();
+    void previewBuilt(FileTrace *preview);
+    void loadingFinished();
+    void showTrace(FileTrace *trace);
     void loadSettings();
     void openNewWindow(QString path);
 
@@ -113,6 +132,9 @@ private: // widgets
     TimeInputField *startTimeInputField = nullptr;
     TimeInputField *endTimeInputField = nullptr;
 
+    QProgressBar *loadingProgressBar = nullptr;
+    QPushButton *cancelLoadingButton = nullptr;
+
     License *licenseWindow = nullptr;
     Help *helpWindow = nullptr;
     About *aboutWindow = nullptr;
@@ -120,11 +142,25 @@ private: // widgets
 private: // properties
     QString filepath;
     TraceDataProxy *data = nullptr;
-
-    otf2::reader::reader *reader = nullptr;
-    ReaderCallbacks *callbacks = nullptr;
+    std::size_t loadJobs = 0;
 
     ViewSettings *settings = nullptr;
+
+    /**
+     * Loading runs on a separate thread, its progress is polled by a timer. The slots read so far are displayed
+     * periodically until the loaded trace is available. Previews are built on a thread of their own, one at a time.
+     * The loader and the slots it published for previews are released once loading finished, a preview still being
+     * built keeps it alive until it is done.
+     */
+    std::shared_ptr<TraceLoader> loader;
+    QThread *loaderThread = nullptr;
+    QTimer *loadingTimer = nullptr;
+    QThreadPool previewPool;
+    bool buildingPreview = false;
+    QElapsedTimer previewTimer;
+    std::uint64_t previewGeneration = 0;
+    FileTrace *loadedTrace = nullptr;
+    QString loadingError;
 };
 
 
@@ -48,24 +48,22 @@ std::map<K, Range<T>, C> groupBy(Range<T> range, std::function<K(const T)> keySe
 
     C keyComparator;
 
-    std::sort(range.begin(), range.end(), compare);
+    // Ranges are immutable, the groups are parts of a single sorted copy
+    std::vector<T> elements(range.begin(), range.end());
+    std::sort(elements.begin(), elements.end(), compare);
+    Range<T> sorted(std::move(elements));
 
-    auto start = range.begin();
-    auto it = range.begin() + 1;
-    while(it != range.end()) {
-        auto key = keySelector(*it);
-        auto startKey = keySelector(*start);
+    std::size_t start = 0;
+    for (std::size_t it = 1; it < sorted.size(); ++it) {
+        auto key = keySelector(sorted[it]);
+        auto startKey = keySelector(sorted[start]);
         if((keyComparator(key, startKey) || keyComparator(startKey, key))) {
-            auto r = std::vector<T>(start, it);
-            group[startKey] = Range<T>(r);
+            group[startKey] = sorted.subrange(start, it);
             start = it;
         }
-
-        it++;
     }
-    auto startKey = keySelector(*start);
-    auto r = std::vector<T>(start, it);
-    group[startKey] = Range<T>(r);
+    auto startKey = keySelector(sorted[start]);
+    group[startKey] = sorted.subrange(start, sorted.size());
 
     return group;
 }
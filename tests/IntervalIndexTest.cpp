@@ -0,0 +1,136 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <random>
+#include <vector>
+#include <QTest>
+
+#include "src/models/IntervalIndex.hpp"
+
+/**
+ * @brief Compares queries of the IntervalIndex with a linear scan of the intervals
+ */
+class IntervalIndexTest : public QObject {
+    Q_OBJECT
+
+private:
+    struct Intervals {
+        std::vector<types::TraceTime> starts;
+        std::vector<types::TraceTime> ends;
+    };
+
+    /**
+     * Intervals sorted by start with durations of up to @p maxDuration, a few of them much longer
+     */
+    static Intervals randomIntervals(std::size_t n, std::int64_t maxDuration, unsigned seed) {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<std::int64_t> gap(0, 20);
+        std::uniform_int_distribution<std::int64_t> duration(0, maxDuration);
+        Intervals intervals;
+        std::int64_t start = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            start += gap(random);
+            auto length = i % 97 == 0 ? 50 * maxDuration : duration(random);
+            intervals.starts.emplace_back(start);
+            intervals.ends.emplace_back(start + length);
+        }
+        return intervals;
+    }
+
+    static std::vector<std::size_t> query(const IntervalIndex &index, const Intervals &intervals,
+                                          std::int64_t from, std::int64_t to) {
+        std::vector<std::size_t> found;
+        index.forEachOverlapping(intervals.starts, intervals.ends, types::TraceTime(from), types::TraceTime(to),
+                                 [&found](std::size_t i) { found.push_back(i); });
+        return found;
+    }
+
+    static std::vector<std::size_t> scan(const Intervals &intervals, std::int64_t from, std::int64_t to) {
+        std::vector<std::size_t> found;
+        for (std::size_t i = 0; i < intervals.starts.size(); ++i) {
+            if (intervals.starts[i].count() < to && intervals.ends[i].count() > from) {
+                found.push_back(i);
+            }
+        }
+        return found;
+    }
+
+private Q_SLOTS:
+    void matchesLinearScan_data() {
+        QTest::addColumn<int>("count");
+        QTest::addColumn<int>("maxDuration");
+
+        QTest::newRow("empty") << 0 << 10;
+        QTest::newRow("single block") << 17 << 10;
+        QTest::newRow("full blocks") << 4 * static_cast<int>(IntervalIndex::BLOCK_SIZE) << 30;
+        QTest::newRow("partial last block") << 1000 << 30;
+        QTest::newRow("long intervals") << 5000 << 2000;
+    }
+
+    void matchesLinearScan() {
+        QFETCH(int, count);
+        QFETCH(int, maxDuration);
+
+        auto intervals = randomIntervals(static_cast<std::size_t>(count), maxDuration, 42);
+        IntervalIndex index(intervals.starts, intervals.ends);
+        auto end = intervals.ends.empty() ? 100 : std::max_element(intervals.ends.begin(), intervals.ends.end())->count();
+
+        std::mt19937 random(7);
+        std::uniform_int_distribution<std::int64_t> time(-100, end + 100);
+        for (int i = 0; i < 200; ++i) {
+            auto from = time(random);
+            auto to = from + time(random) / 8;
+            QCOMPARE(query(index, intervals, from, to), scan(intervals, from, to));
+        }
+
+        // Windows covering everything and touching the borders of intervals
+        QCOMPARE(query(index, intervals, -1, end + 1), scan(intervals, -1, end + 1));
+        if (count > 0) {
+            auto start = intervals.starts[intervals.starts.size() / 2].count();
+            QCOMPARE(query(index, intervals, start, start), scan(intervals, start, start));
+            QCOMPARE(query(index, intervals, start - 1, start), scan(intervals, start - 1, start));
+            QCOMPARE(query(index, intervals, start, start + 1), scan(intervals, start, start + 1));
+        }
+    }
+
+    void unsortedIntervalsAreScanned() {
+        Intervals intervals;
+        for (std::int64_t start: {50, 10, 30, 0, 20}) {
+            intervals.starts.emplace_back(start);
+            intervals.ends.emplace_back(start + 15);
+        }
+
+        IntervalIndex index(intervals.starts, intervals.ends);
+        QCOMPARE(index.bytes(), std::size_t(0));
+        QCOMPARE(query(index, intervals, 25, 40), scan(intervals, 25, 40));
+    }
+
+    void clearedIndexIsScanned() {
+        auto intervals = randomIntervals(300, 10, 3);
+        IntervalIndex index(intervals.starts, intervals.ends);
+        QVERIFY(index.bytes() > 0);
+
+        // The intervals may change after the index was cleared
+        index.clear();
+        intervals.ends[299] = types::TraceTime(1'000'000);
+        QCOMPARE(query(index, intervals, 500'000, 600'000), std::vector<std::size_t>{299});
+    }
+};
+
+QTEST_APPLESS_MAIN(IntervalIndexTest)
+
+#include "IntervalIndexTest.moc"
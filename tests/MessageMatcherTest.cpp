@@ -0,0 +1,120 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <array>
+#include <set>
+#include <QTest>
+
+#include "src/MessageMatcher.hpp"
+
+/**
+ * @brief Tests matching sends and receives in order per key
+ *
+ * The matcher only stores and compares the events and communicators, so the tests pass addresses of placeholders.
+ */
+class MessageMatcherTest : public QObject {
+    Q_OBJECT
+
+private:
+    std::array<char, 4096> events_{};
+    std::array<char, 2> communicators_{};
+
+    CommunicationEvent *event(std::size_t i) {
+        return reinterpret_cast<CommunicationEvent *>(&events_[i]);
+    }
+
+    const types::communicator *communicator(std::size_t i) {
+        return reinterpret_cast<const types::communicator *>(&communicators_[i]);
+    }
+
+    MessageMatcher::Key key(std::uint64_t sender, std::uint64_t receiver, std::uint32_t tag = 0, std::size_t comm = 0) {
+        return {communicator(comm), sender, receiver, tag};
+    }
+
+private Q_SLOTS:
+    void matchesInOrder() {
+        MessageMatcher matcher;
+        QCOMPARE(matcher.match(MessageMatcher::Send, key(0, 1), event(0)), nullptr);
+        QCOMPARE(matcher.match(MessageMatcher::Send, key(0, 1), event(1)), nullptr);
+        QCOMPARE(matcher.pending(MessageMatcher::Send), std::size_t(2));
+
+        QCOMPARE(matcher.match(MessageMatcher::Receive, key(0, 1), event(2)), event(0));
+        QCOMPARE(matcher.match(MessageMatcher::Receive, key(0, 1), event(3)), event(1));
+        QCOMPARE(matcher.pending(MessageMatcher::Send), std::size_t(0));
+
+        // Receives posted before their sends are queued as well
+        QCOMPARE(matcher.match(MessageMatcher::Receive, key(0, 1), event(4)), nullptr);
+        QCOMPARE(matcher.pending(MessageMatcher::Receive), std::size_t(1));
+        QCOMPARE(matcher.match(MessageMatcher::Send, key(0, 1), event(5)), event(4));
+        QCOMPARE(matcher.pending(MessageMatcher::Receive), std::size_t(0));
+    }
+
+    void keysAreMatchedSeparately() {
+        MessageMatcher matcher;
+        matcher.match(MessageMatcher::Send, key(0, 1, 0, 0), event(0));
+        matcher.match(MessageMatcher::Send, key(0, 1, 1, 0), event(1));
+        matcher.match(MessageMatcher::Send, key(0, 1, 0, 1), event(2));
+        matcher.match(MessageMatcher::Send, key(1, 0, 0, 0), event(3));
+
+        QCOMPARE(matcher.match(MessageMatcher::Receive, key(1, 0, 0, 0), event(4)), event(3));
+        QCOMPARE(matcher.match(MessageMatcher::Receive, key(0, 1, 0, 1), event(5)), event(2));
+        QCOMPARE(matcher.match(MessageMatcher::Receive, key(0, 1, 1, 0), event(6)), event(1));
+        QCOMPARE(matcher.match(MessageMatcher::Receive, key(0, 1, 0, 0), event(7)), event(0));
+        QCOMPARE(matcher.match(MessageMatcher::Receive, key(0, 1, 0, 0), event(8)), nullptr);
+    }
+
+    void tableGrows() {
+        // More keys than the initial capacity of the table, each with a pending send
+        MessageMatcher matcher;
+        const std::size_t keys = 3000;
+        for (std::size_t i = 0; i < keys; ++i) {
+            QCOMPARE(matcher.match(MessageMatcher::Send, key(i, i + 1, 7), event(i)), nullptr);
+        }
+        QCOMPARE(matcher.pending(MessageMatcher::Send), keys);
+
+        for (std::size_t i = 0; i < keys; ++i) {
+            QCOMPARE(matcher.match(MessageMatcher::Receive, key(i, i + 1, 7), event(keys + i % 1000)), event(i));
+        }
+        QCOMPARE(matcher.pending(MessageMatcher::Send), std::size_t(0));
+        QCOMPARE(matcher.pending(MessageMatcher::Receive), std::size_t(0));
+    }
+
+    void pendingEventsAreListed() {
+        MessageMatcher matcher;
+        matcher.match(MessageMatcher::Send, key(0, 1), event(0));
+        matcher.match(MessageMatcher::Send, key(0, 1), event(1));
+        matcher.match(MessageMatcher::Receive, key(2, 3), event(2));
+        matcher.match(MessageMatcher::Receive, key(0, 1), event(3));
+
+        std::set<CommunicationEvent *> pending;
+        matcher.forEachPending([&](MessageMatcher::Side side, const MessageMatcher::Key &pendingKey,
+                                   CommunicationEvent *pendingEvent) {
+            QVERIFY((side == MessageMatcher::Send) == (pendingKey == key(0, 1)));
+            pending.insert(pendingEvent);
+        });
+        QCOMPARE(pending, (std::set<CommunicationEvent *>{event(1), event(2)}));
+
+        matcher.clear();
+        QCOMPARE(matcher.pending(MessageMatcher::Send), std::size_t(0));
+        QCOMPARE(matcher.pending(MessageMatcher::Receive), std::size_t(0));
+        QCOMPARE(matcher.match(MessageMatcher::Receive, key(0, 1), event(4)), nullptr);
+    }
+};
+
+QTEST_APPLESS_MAIN(MessageMatcherTest)
+
+#include "MessageMatcherTest.moc"
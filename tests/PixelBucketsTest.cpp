@@ -0,0 +1,161 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <QTest>
+
+#include "src/models/PixelBuckets.hpp"
+
+/**
+ * @brief Source of the kernel reading elements of two kinds from vectors
+ */
+class VectorSource {
+public:
+    static constexpr std::size_t KINDS = 2;
+
+    void add(std::int64_t start, std::int64_t end, std::size_t kind) {
+        starts_.emplace_back(start);
+        ends_.emplace_back(end);
+        kinds_.push_back(kind);
+    }
+
+    [[nodiscard]] std::size_t size() const { return starts_.size(); }
+
+    [[nodiscard]] types::TraceTime start(std::size_t i) const { return starts_[i]; }
+
+    [[nodiscard]] types::TraceTime end(std::size_t i) const { return ends_[i]; }
+
+    [[nodiscard]] std::size_t kind(std::size_t i) const { return kinds_[i]; }
+
+private:
+    std::vector<types::TraceTime> starts_;
+    std::vector<types::TraceTime> ends_;
+    std::vector<std::size_t> kinds_;
+};
+
+/**
+ * @brief Tests the statistics the pixel bucket kernel keeps per bucket
+ */
+class PixelBucketsTest : public QObject {
+    Q_OBJECT
+
+private:
+    using Kernel = PixelBuckets<VectorSource>;
+
+    struct Result {
+        std::vector<std::size_t> kept;
+        std::vector<Kernel::Bucket> buckets;
+    };
+
+    static Result run(const VectorSource &source, std::int64_t width) {
+        Result result;
+        Kernel::run(source, types::TraceTime(width),
+                    [&result](std::size_t i) { result.kept.push_back(i); },
+                    [&result](const Kernel::Bucket &bucket) { result.buckets.push_back(bucket); });
+        return result;
+    }
+
+private Q_SLOTS:
+    void longElementsAreKept() {
+        VectorSource source;
+        source.add(0, 10, 0);
+        source.add(10, 12, 1);
+        source.add(12, 30, 1);
+
+        auto result = run(source, 10);
+        QCOMPARE(result.kept, (std::vector<std::size_t>{0, 2}));
+        QCOMPARE(result.buckets.size(), std::size_t(1));
+        QCOMPARE(result.buckets[0].first, std::size_t(1));
+    }
+
+    void shortElementsAreBinnedByStart() {
+        VectorSource source;
+        source.add(0, 2, 1);
+        source.add(3, 9, 1);
+        source.add(5, 6, 0);
+        source.add(9, 14, 1);
+        source.add(25, 26, 0);
+
+        auto result = run(source, 10);
+        QVERIFY(result.kept.empty());
+        QCOMPARE(result.buckets.size(), std::size_t(2));
+
+        const auto &first = result.buckets[0];
+        QCOMPARE(first.first, std::size_t(0));
+        QCOMPARE(first.count[0], 1u);
+        QCOMPARE(first.count[1], 3u);
+        QCOMPARE(first.dominant(), std::size_t(0));
+
+        // The element crossing into the next bucket still belongs to the bucket it starts in
+        QCOMPARE(first.start[1], types::TraceTime(0));
+        QCOMPARE(first.end[1], types::TraceTime(14));
+        QCOMPARE(first.longest[1], std::size_t(1));
+        QCOMPARE(first.longestDuration[1], types::TraceTime(6));
+        QCOMPARE(first.total[1], types::TraceTime(13));
+        QCOMPARE(first.longest[0], std::size_t(2));
+        QCOMPARE(first.end[0], types::TraceTime(6));
+
+        const auto &second = result.buckets[1];
+        QCOMPARE(second.first, std::size_t(4));
+        QCOMPARE(second.count[1], 0u);
+        QCOMPARE(second.dominant(), std::size_t(0));
+    }
+
+    void dominantKindIsMostImportant() {
+        VectorSource source;
+        source.add(0, 1, 1);
+        source.add(1, 9, 1);
+
+        auto result = run(source, 10);
+        QCOMPARE(result.buckets.size(), std::size_t(1));
+        QCOMPARE(result.buckets[0].dominant(), std::size_t(1));
+    }
+
+    void bucketsAreAlignedBelowZero() {
+        VectorSource source;
+        source.add(-15, -14, 0);
+        source.add(-11, -10, 0);
+        source.add(-5, -4, 0);
+        source.add(0, 1, 0);
+
+        auto result = run(source, 10);
+        QCOMPARE(result.buckets.size(), std::size_t(3));
+        QCOMPARE(result.buckets[0].count[0], 2u);
+        QCOMPARE(result.buckets[1].first, std::size_t(2));
+        QCOMPARE(result.buckets[2].first, std::size_t(3));
+    }
+
+    void nonPositiveWidthKeepsAll() {
+        VectorSource source;
+        source.add(0, 1, 0);
+        source.add(1, 2, 1);
+
+        auto result = run(source, 0);
+        QCOMPARE(result.kept, (std::vector<std::size_t>{0, 1}));
+        QVERIFY(result.buckets.empty());
+    }
+
+    void emptySourceReportsNothing() {
+        auto result = run(VectorSource(), 10);
+        QVERIFY(result.kept.empty());
+        QVERIFY(result.buckets.empty());
+    }
+};
+
+QTEST_APPLESS_MAIN(PixelBucketsTest)
+
+#include "PixelBucketsTest.moc"
@@ -0,0 +1,78 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MOTIV_TESTDEFINITIONS_HPP
+#define MOTIV_TESTDEFINITIONS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "src/models/DefinitionRegistry.hpp"
+
+/**
+ * @brief Definitions of synthetic traces used by the tests
+ *
+ * All location groups are placed below a single system tree node. The kind of a region is derived from its name like
+ * for real traces, e.g. regions named MPI_* are MPI regions.
+ */
+class TestDefinitions {
+public:
+    TestDefinitions() :
+        registry(std::make_shared<DefinitionRegistry>(DefinitionRegistry::KindColors{})),
+        node_(otf2::reference<otf2::definition::system_tree_node>(0), string("machine"), string("machine")) {}
+
+    /**
+     * @brief Adds a region to the registry
+     * @param name Name of the region
+     * @return Index of the region
+     */
+    std::uint32_t addRegion(const std::string &name) {
+        auto ref = nextRegion_++;
+        registry->add(otf2::definition::region(otf2::reference<otf2::definition::region>(ref), string(name),
+                                               string(name), string(""), otf2::common::role_type::function,
+                                               otf2::common::paradigm_type::user, otf2::common::flags_type::none,
+                                               string(""), 0, 0));
+        return ref;
+    }
+
+    /**
+     * @brief Adds a location group (rank) to the registry
+     * @param name Name of the location group
+     * @return The interned location group
+     */
+    otf2::definition::location_group *addLocationGroup(const std::string &name) {
+        auto ref = otf2::reference<otf2::definition::location_group>(nextLocationGroup_++);
+        registry->add(otf2::definition::location_group(ref, string(name),
+                                                       otf2::common::location_group_type::process, node_));
+        return registry->locationGroup(ref);
+    }
+
+    std::shared_ptr<DefinitionRegistry> registry;
+
+private:
+    otf2::definition::string string(const std::string &value) {
+        return otf2::definition::string(otf2::reference<otf2::definition::string>(nextString_++), value);
+    }
+
+    std::uint32_t nextString_ = 0;
+    std::uint32_t nextRegion_ = 0;
+    std::uint32_t nextLocationGroup_ = 0;
+    otf2::definition::system_tree_node node_;
+};
+
+#endif //MOTIV_TESTDEFINITIONS_HPP
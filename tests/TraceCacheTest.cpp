@@ -0,0 +1,146 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <filesystem>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "TestDefinitions.hpp"
+#include "src/TraceCache.hpp"
+
+/**
+ * @brief Tests writing the model of a trace to its cache and reading it back
+ */
+class TraceCacheTest : public QObject {
+    Q_OBJECT
+
+private:
+    TestDefinitions definitions_;
+    std::uint32_t compute_ = 0;
+    std::uint32_t send_ = 0;
+    otf2::definition::location_group *first_ = nullptr;
+    otf2::definition::location_group *second_ = nullptr;
+
+    QTemporaryDir dir_;
+    std::string tracePath_;
+
+    [[nodiscard]] TraceModel model(std::uint32_t region, std::uint32_t depth) const {
+        TraceModel model;
+        model.runtime = types::TraceTime(1000);
+        model.regions = {compute_, send_};
+
+        SlotStore first(definitions_.registry.get());
+        first.push_back(types::TraceTime(0), types::TraceTime(1000), compute_, 0);
+        first.push_back(types::TraceTime(10), types::TraceTime(20), send_, 1);
+        first.push_back(types::TraceTime(30), types::TraceTime(35), region, depth);
+        model.slots.insert({first_, std::move(first)});
+
+        SlotStore second(definitions_.registry.get());
+        second.push_back(types::TraceTime(5), types::TraceTime(900), send_, 0);
+        model.slots.insert({second_, std::move(second)});
+        return model;
+    }
+
+    static void compareSlots(const SlotStore &actual, const SlotStore &expected) {
+        QCOMPARE(actual.size(), expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            QCOMPARE(actual.starts()[i], expected.starts()[i]);
+            QCOMPARE(actual.ends()[i], expected.ends()[i]);
+            QCOMPARE(actual.regionIndices()[i], expected.regionIndices()[i]);
+            QCOMPARE(actual.depths()[i], expected.depths()[i]);
+        }
+    }
+
+    void appendToFile(const QString &path, const QByteArray &data) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::Append));
+        QCOMPARE(file.write(data), qint64(data.size()));
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        compute_ = definitions_.addRegion("compute");
+        send_ = definitions_.addRegion("MPI_Send");
+        first_ = definitions_.addLocationGroup("rank 0");
+        second_ = definitions_.addLocationGroup("rank 1");
+
+        // The anchor file is part of the fingerprint of the archive
+        QVERIFY(dir_.isValid());
+        tracePath_ = dir_.filePath("trace.otf2").toStdString();
+        appendToFile(QString::fromStdString(tracePath_), "anchor");
+    }
+
+    void roundTrip() {
+        auto written = model(compute_, 2);
+        QVERIFY(TraceCache(tracePath_).write(written));
+
+        TraceCache cache(tracePath_);
+        QVERIFY(cache.open());
+        auto read = cache.read(*definitions_.registry);
+        QVERIFY(read);
+        QCOMPARE(read->runtime, written.runtime);
+        QCOMPARE(read->regions, written.regions);
+        QVERIFY(read->communicationRecords.empty());
+        QCOMPARE(read->slots.size(), written.slots.size());
+        for (const auto &[locationGroup, slots]: written.slots) {
+            QVERIFY(read->slots.contains(locationGroup));
+            compareSlots(read->slots.at(locationGroup), slots);
+            QCOMPARE(read->slots.at(locationGroup).definitions(), definitions_.registry.get());
+        }
+    }
+
+    void undefinedRegionsAreRejected() {
+        QVERIFY(TraceCache(tracePath_).write(model(99, 2)));
+
+        TraceCache cache(tracePath_);
+        QVERIFY(cache.open());
+        QVERIFY(!cache.read(*definitions_.registry));
+    }
+
+    void invalidDepthsAreRejected() {
+        // The first location group has three slots, so no call stack is three slots deep
+        QVERIFY(TraceCache(tracePath_).write(model(compute_, 3)));
+
+        TraceCache cache(tracePath_);
+        QVERIFY(cache.open());
+        QVERIFY(!cache.read(*definitions_.registry));
+    }
+
+    void truncatedCacheIsRejected() {
+        QVERIFY(TraceCache(tracePath_).write(model(compute_, 2)));
+
+        auto cachePath = std::filesystem::path(tracePath_).replace_extension(".motivcache");
+        QFile file(QString::fromStdString(cachePath.string()));
+        QVERIFY(file.resize(file.size() - 8));
+
+        TraceCache cache(tracePath_);
+        QVERIFY(cache.open());
+        QVERIFY(!cache.read(*definitions_.registry));
+    }
+
+    void changedTraceIsRejected() {
+        QVERIFY(TraceCache(tracePath_).write(model(compute_, 2)));
+        appendToFile(QString::fromStdString(tracePath_), "changed");
+        QVERIFY(!TraceCache(tracePath_).open());
+    }
+};
+
+QTEST_APPLESS_MAIN(TraceCacheTest)
+
+#include "TraceCacheTest.moc"
@@ -0,0 +1,173 @@
+/*
+ * Marvelous OTF2 Traces Interactive Visualizer (MOTIV)
+ * Copyright (C) 2023 Florian Gallrein, Björn Gehrke
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+#include <QTest>
+
+#include "TestDefinitions.hpp"
+#include "src/models/Filetrace.hpp"
+#include "src/models/UITrace.hpp"
+
+/**
+ * @brief Tests that splicing a panned window yields the same selection as collecting the window anew
+ */
+class UITraceTest : public QObject {
+    Q_OBJECT
+
+private:
+    using SlotTuple = std::tuple<std::int64_t, std::int64_t, std::uint32_t>;
+
+    TestDefinitions definitions_;
+    std::vector<otf2::definition::location_group *> ranks_;
+    std::unique_ptr<FileTrace> trace_;
+
+    /**
+     * Slots of a location group sorted by start, end and region, summaries starting together may be ordered either way
+     */
+    static std::vector<SlotTuple> slotsOf(const Trace *trace, otf2::definition::location_group *rank) {
+        std::vector<SlotTuple> result;
+        const auto &slots = trace->getSlots().at(rank);
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            result.emplace_back(slots.starts()[i].count(), slots.ends()[i].count(), slots.regionIndices()[i]);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void comparePan(std::int64_t from, std::int64_t duration, std::int64_t timePerPixel, std::int64_t shift,
+                    const std::unordered_set<otf2::definition::location_group *> *ranks,
+                    const std::vector<bool> *regions) {
+        auto resolution = types::TraceTime(timePerPixel);
+        std::unique_ptr<UITrace> previous(UITrace::forWindow(trace_.get(), types::TraceTime(from),
+                                                             types::TraceTime(from + duration), resolution, ranks,
+                                                             regions));
+        auto begin = types::TraceTime(from + shift);
+        auto end = types::TraceTime(from + shift + duration);
+        std::unique_ptr<UITrace> panned(UITrace::forPan(previous.get(), trace_.get(), begin, end, resolution, ranks,
+                                                        regions));
+        std::unique_ptr<UITrace> collected(UITrace::forWindow(trace_.get(), begin, end, resolution, ranks, regions));
+
+        QVERIFY(panned);
+        QCOMPARE(panned->getStartTime(), collected->getStartTime());
+        QCOMPARE(panned->getRuntime(), collected->getRuntime());
+        QCOMPARE(panned->getSlots().size(), collected->getSlots().size());
+        for (auto rank: ranks_) {
+            QCOMPARE(slotsOf(panned.get(), rank), slotsOf(collected.get(), rank));
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        auto mainRegion = definitions_.addRegion("main");
+        auto compute = definitions_.addRegion("compute");
+        auto send = definitions_.addRegion("MPI_Send");
+        auto receive = definitions_.addRegion("MPI_Recv");
+        auto parallel = definitions_.addRegion("!$omp parallel");
+        const std::uint32_t inner[] = {compute, send, receive, parallel};
+
+        // Every rank runs main with many short and a few long calls below it
+        std::mt19937 random(1);
+        std::uniform_int_distribution<std::size_t> region(0, 3);
+        std::uniform_int_distribution<std::int64_t> shortDuration(1, 40);
+        std::uniform_int_distribution<std::int64_t> longDuration(500, 5000);
+        std::uniform_int_distribution<std::int64_t> gap(0, 30);
+
+        std::map<otf2::definition::location_group *, SlotStore, LocationGroupCmp> slots;
+        std::int64_t runtime = 0;
+        for (int rank = 0; rank < 4; ++rank) {
+            auto locationGroup = definitions_.addLocationGroup("rank " + std::to_string(rank));
+            ranks_.push_back(locationGroup);
+
+            SlotStore store(definitions_.registry.get());
+            std::int64_t time = 1;
+            for (int call = 0; call < 5000; ++call) {
+                time += gap(random);
+                auto duration = call % 50 == 0 ? longDuration(random) : shortDuration(random);
+                store.push_back(types::TraceTime(time), types::TraceTime(time + duration), inner[region(random)], 1);
+                time += duration;
+            }
+            store.push_back(types::TraceTime(0), types::TraceTime(time + 1), mainRegion, 0);
+            store.sortByStart();
+            runtime = std::max(runtime, time + 1);
+            slots.insert({locationGroup, std::move(store)});
+        }
+
+        std::vector<Communication *> communications;
+        std::vector<CollectiveCommunicationEvent *> collectiveCommunications;
+        trace_ = std::make_unique<FileTrace>(slots, communications, collectiveCommunications,
+                                             types::TraceTime(runtime),
+                                             std::vector<std::uint32_t>{mainRegion, compute, send, receive, parallel},
+                                             definitions_.registry);
+    }
+
+    void panMatchesWindow_data() {
+        QTest::addColumn<qint64>("from");
+        QTest::addColumn<qint64>("duration");
+        QTest::addColumn<qint64>("timePerPixel");
+        QTest::addColumn<qint64>("shift");
+
+        QTest::newRow("unsummarized right") << qint64(10'000) << qint64(2'000) << qint64(1) << qint64(300);
+        QTest::newRow("unsummarized left") << qint64(10'000) << qint64(2'000) << qint64(1) << qint64(-300);
+        QTest::newRow("pixel aligned right") << qint64(70'000) << qint64(70'000) << qint64(70) << qint64(7'000);
+        QTest::newRow("pixel aligned left") << qint64(70'000) << qint64(70'000) << qint64(70) << qint64(-7'000);
+        QTest::newRow("unaligned window") << qint64(12'345) << qint64(50'000) << qint64(50) << qint64(1'234);
+        QTest::newRow("almost disjoint") << qint64(20'000) << qint64(30'000) << qint64(30) << qint64(29'000);
+        QTest::newRow("pyramid level") << qint64(0) << qint64(400'000) << qint64(400) << qint64(40'000);
+    }
+
+    void panMatchesWindow() {
+        QFETCH(qint64, from);
+        QFETCH(qint64, duration);
+        QFETCH(qint64, timePerPixel);
+        QFETCH(qint64, shift);
+
+        comparePan(from, duration, timePerPixel, shift, nullptr, nullptr);
+    }
+
+    void panMatchesFilteredWindow() {
+        // Only the MPI slots of every other rank
+        std::unordered_set<otf2::definition::location_group *> ranks{ranks_[0], ranks_[2]};
+        auto regions = definitions_.registry->regionMask(MPI);
+        comparePan(30'000, 60'000, 60, 6'000, &ranks, &regions);
+        comparePan(30'000, 60'000, 60, -6'000, &ranks, &regions);
+    }
+
+    void panRejectsOtherWindows() {
+        auto resolution = types::TraceTime(10);
+        std::unique_ptr<UITrace> previous(UITrace::forWindow(trace_.get(), types::TraceTime(10'000),
+                                                             types::TraceTime(20'000), resolution));
+
+        // Disjoint windows, other durations and other resolutions are collected anew
+        QCOMPARE(UITrace::forPan(previous.get(), trace_.get(), types::TraceTime(30'000), types::TraceTime(40'000),
+                                 resolution), nullptr);
+        QCOMPARE(UITrace::forPan(previous.get(), trace_.get(), types::TraceTime(11'000), types::TraceTime(22'000),
+                                 resolution), nullptr);
+        QCOMPARE(UITrace::forPan(previous.get(), trace_.get(), types::TraceTime(11'000), types::TraceTime(21'000),
+                                 types::TraceTime(20)), nullptr);
+    }
+};
+
+QTEST_APPLESS_MAIN(UITraceTest)
+
+#include "UITraceTest.moc"